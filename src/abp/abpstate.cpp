@@ -2,6 +2,7 @@
 #include <util.h>
 #include <validation.h>
 #include <chainparams.h>
+#include <undo.h>
 #include <abp/abpstate.h>
 
 using namespace std;
@@ -14,6 +15,12 @@ AbpState::AbpState(u256 const& _accountStartNonce, OverlayDB const& _db, const s
 	        stateUTXO = SecureTrieDB<Address, OverlayDB>(&dbUTXO);
 }
 
+AbpState::AbpState(u256 const& _accountStartNonce, OverlayDB const& _db, OverlayDB const& _dbUTXO, BaseState _bs) :
+        State(_accountStartNonce, _db, _bs) {
+    dbUTXO = _dbUTXO;
+    stateUTXO = SecureTrieDB<Address, OverlayDB>(&dbUTXO);
+}
+
 AbpState::AbpState() : dev::eth::State(dev::Invalid256, dev::OverlayDB(), dev::eth::BaseState::PreExisting) {
     dbUTXO = OverlayDB();
     stateUTXO = SecureTrieDB<Address, OverlayDB>(&dbUTXO);
@@ -60,8 +67,9 @@ ResultExecute AbpState::execute(EnvInfo const& _envInfo, SealEngineFace const& _
         }
         e.finalize();
         if (_p == Permanence::Reverted){
-            m_cache.clear();
-            cacheUTXO.clear();
+            // Committed accounts and vins stay cached, only the changes since are undone
+            rollback(0);
+            revertUTXO();
         } else {
             deleteAccounts(_sealEngine.deleteAddresses);
             if(res.excepted == TransactionException::None){
@@ -79,8 +87,9 @@ ResultExecute AbpState::execute(EnvInfo const& _envInfo, SealEngineFace const& _
                 printfErrorLog(res.excepted);
             }
             
-            abp::commit(cacheUTXO, stateUTXO, m_cache);
-            cacheUTXO.clear();
+            recordUndo();
+            abp::commit(cacheUTXO, changedUTXO, stateUTXO);
+            changedUTXO.clear();
             bool removeEmptyAccounts = _envInfo.number() >= _sealEngine.chainParams().u256Param("EIP158ForkBlock");
             commit(removeEmptyAccounts ? State::CommitBehaviour::RemoveEmptyAccounts : State::CommitBehaviour::KeepEmptyAccounts);
         }
@@ -93,10 +102,11 @@ ResultExecute AbpState::execute(EnvInfo const& _envInfo, SealEngineFace const& _
         const Consensus::Params& consensusParams = Params().GetConsensus();
         if(chainActive.Height() < consensusParams.nFixUTXOCacheHFHeight  && _p != Permanence::Reverted){
             deleteAccounts(_sealEngine.deleteAddresses);
+            recordUndo();
             commit(CommitBehaviour::RemoveEmptyAccounts);
         } else {
-            m_cache.clear();
-            cacheUTXO.clear();
+            rollback(0);
+            revertUTXO();
         }
     }
 
@@ -127,6 +137,23 @@ ResultExecute AbpState::execute(EnvInfo const& _envInfo, SealEngineFace const& _
     }
 }
 
+void AbpState::setCacheUTXO(dev::Address const& address, Vin const& vin){
+    if(cacheUTXO.count(address))
+        return;
+    noteVinChange(address);
+    cacheUTXO[address] = vin;
+}
+
+void AbpState::clearCache(){
+    State::clearCache();
+    std::vector<dev::Address> unchanged;
+    for(auto const& i : cacheUTXO)
+        if(!changedUTXO.count(i.first))
+            unchanged.push_back(i.first);
+    for(auto const& a : unchanged)
+        cacheUTXO.erase(a);
+}
+
 std::unordered_map<dev::Address, Vin> AbpState::vins() const // temp
 {
     std::unordered_map<dev::Address, Vin> ret;
@@ -162,16 +189,31 @@ Vin* AbpState::vin(dev::Address const& _addr)
             return nullptr;
             
         dev::RLP state(stateBack);
-        auto i = cacheUTXO.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(_addr),
-            std::forward_as_tuple(Vin{state[0].toHash<dev::h256>(), state[1].toInt<uint32_t>(), state[2].toInt<dev::u256>(), state[3].toInt<uint8_t>()})
-        );
+        auto i = cacheUTXO.emplace(_addr, Vin{state[0].toHash<dev::h256>(), state[1].toInt<uint32_t>(), state[2].toInt<dev::u256>(), state[3].toInt<uint8_t>()});
         return &i.first->second;
     }
     return &it->second;
 }
 
+void AbpState::noteVinChange(dev::Address const& _addr)
+{
+    if(changedUTXO.count(_addr))
+        return;
+    Vin const* v = vin(_addr);
+    changedUTXO.emplace(_addr, v ? boost::optional<Vin>(*v) : boost::none);
+}
+
+void AbpState::revertUTXO()
+{
+    for(auto const& c : changedUTXO){
+        if(c.second)
+            cacheUTXO[c.first] = *c.second;
+        else
+            cacheUTXO.erase(c.first);
+    }
+    changedUTXO.clear();
+}
+
 // void AbpState::commit(CommitBehaviour _commitBehaviour)
 // {
 //     if (_commitBehaviour == CommitBehaviour::RemoveEmptyAccounts)
@@ -189,23 +231,24 @@ Vin* AbpState::vin(dev::Address const& _addr)
 void AbpState::kill(dev::Address _addr)
 {
     // If the account is not in the db, nothing to kill.
-    if (auto a = account(_addr))
-        a->kill();
-    if (auto v = vin(_addr))
-        v->alive = 0;
+    State::kill(_addr);
+    if (vin(_addr)){
+        noteVinChange(_addr);
+        vin(_addr)->alive = 0;
+    }
 }
 
 void AbpState::addBalance(dev::Address const& _id, dev::u256 const& _amount)
 {
     if (dev::eth::Account* a = account(_id))
     {
-            // Log empty account being touched. Empty touched accounts are cleared
-            // after the transaction, so this event must be also reverted.
-            // We only log the first touch (not dirty yet), and only for empty
-            // accounts, as other accounts does not matter.
+            // Log the account being touched. Empty touched accounts are cleared
+            // after the transaction, and other accounts stay cached after the
+            // commit, so this event must be also reverted. We only log the first
+            // touch (not dirty yet).
             // TODO: to save space we can combine this event with Balance by having
             //       Balance and Balance+Touch events.
-        if (!a->isDirty() && a->isEmpty())
+        if (!a->isDirty())
             m_changeLog.emplace_back(dev::eth::detail::Change::Touch, _id);
 
             // Increase the account balance. This also is done for value 0 to mark
@@ -244,14 +287,8 @@ dev::Address AbpState::createAbpAddress(dev::h256 hashTx, uint32_t voutNumber){
 }
 
 void AbpState::deleteAccounts(std::set<dev::Address>& addrs){
-    for(dev::Address addr : addrs){
-        dev::eth::Account* acc = const_cast<dev::eth::Account*>(account(addr));
-        if(acc)
-            acc->kill();
-        Vin* in = const_cast<Vin*>(vin(addr));
-        if(in)
-            in->alive = 0;
-    }
+    for(dev::Address addr : addrs)
+        kill(addr);
 }
 
 void AbpState::updateUTXO(const std::unordered_map<dev::Address, Vin>& vins){
@@ -259,16 +296,109 @@ void AbpState::updateUTXO(const std::unordered_map<dev::Address, Vin>& vins){
         Vin* vi = const_cast<Vin*>(vin(v.first));
 
         if(vi){
+            noteVinChange(v.first);
             vi->hash = v.second.hash;
             vi->nVout = v.second.nVout;
             vi->value = v.second.value;
             vi->alive = v.second.alive;
         } else if(v.second.alive > 0) {
+            noteVinChange(v.first);
             cacheUTXO[v.first] = v.second;
         }
     }
 }
 
+void AbpState::setStateUndo(CContractUndo* _undo){
+    stateUndo = _undo;
+    undoAccounts.clear();
+    undoSlots.clear();
+    undoUTXOs.clear();
+}
+
+void AbpState::recordUndo(){
+    if(!stateUndo)
+        return;
+
+    for(auto const& i : m_cache){
+        if(!i.second.isDirty())
+            continue;
+
+        // Nothing of this block is committed for an address until it is first
+        // recorded, so what the trie holds now is its value before the block
+        std::string committed = m_state.at(i.first);
+        auto it = undoAccounts.find(i.first);
+        if(it == undoAccounts.end()){
+            CAccountUndo account;
+            memcpy(account.address.begin(), i.first.data(), dev::Address::size);
+            account.vchPrior.assign(committed.begin(), committed.end());
+            it = undoAccounts.emplace(i.first, stateUndo->vAccounts.size()).first;
+            stateUndo->vAccounts.push_back(account);
+        }
+
+        if(i.second.storageOverlay().empty())
+            continue;
+        SecureTrieDB<h256, OverlayDB> storageDB(&m_db, committed.empty() ? EmptyTrie : RLP(committed)[2].toHash<h256>());
+        for(auto const& j : i.second.storageOverlay()){
+            h256 key(j.first);
+            if(undoSlots.count(std::make_pair(i.first, key)))
+                continue;
+            std::string prior = storageDB.at(key);
+            // A slot may have been set back to its prior value
+            if(prior.empty() ? j.second == 0 : RLP(prior).toInt<u256>() == j.second)
+                continue;
+            undoSlots.insert(std::make_pair(i.first, key));
+            uint256 slot;
+            memcpy(slot.begin(), key.data(), h256::size);
+            stateUndo->vAccounts[it->second].vStorage.push_back(std::make_pair(slot, valtype(prior.begin(), prior.end())));
+        }
+    }
+
+    for(auto const& i : changedUTXO){
+        if(!undoUTXOs.insert(i.first).second)
+            continue;
+        std::string prior = stateUTXO.at(i.first);
+        uint160 address;
+        memcpy(address.begin(), i.first.data(), dev::Address::size);
+        stateUndo->vUTXOs.push_back(std::make_pair(address, valtype(prior.begin(), prior.end())));
+    }
+}
+
+void AbpState::applyUndo(CContractUndo const& _undo){
+    setRoot(rootHash());
+    setRootUTXO(rootHashUTXO());
+
+    for(CAccountUndo const& account : _undo.vAccounts){
+        dev::Address address(bytesConstRef(account.address.begin(), dev::Address::size));
+        std::string current = m_state.at(address);
+        if(!account.vStorage.empty() && !current.empty()){
+            // Rebuild the prior storage trie from the current one, so that it
+            // does not depend on the old trie nodes still being in the database
+            SecureTrieDB<h256, OverlayDB> storageDB(&m_db, RLP(current)[2].toHash<h256>());
+            for(auto const& slot : account.vStorage){
+                h256 key(bytesConstRef(slot.first.begin(), h256::size));
+                if(slot.second.empty())
+                    storageDB.remove(key);
+                else
+                    storageDB.insert(key, bytesConstRef(slot.second.data(), slot.second.size()));
+            }
+        }
+        if(account.vchPrior.empty())
+            m_state.remove(address);
+        else
+            m_state.insert(address, bytesConstRef(account.vchPrior.data(), account.vchPrior.size()));
+    }
+
+    for(auto const& utxo : _undo.vUTXOs){
+        dev::Address address(bytesConstRef(utxo.first.begin(), dev::Address::size));
+        if(utxo.second.empty())
+            stateUTXO.remove(address);
+        else
+            stateUTXO.insert(address, bytesConstRef(utxo.second.data(), utxo.second.size()));
+    }
+
+    setRoot(rootHash());
+}
+
 void AbpState::printfErrorLog(const dev::eth::TransactionException er){
     std::stringstream ss;
     ss << er;
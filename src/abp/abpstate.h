@@ -11,6 +11,8 @@
 #include <libethereum/Executive.h>
 #include <libethcore/SealEngine.h>
 
+#include <boost/optional.hpp>
+
 using OnOpFunc = std::function<void(uint64_t, uint64_t, dev::eth::Instruction, dev::bigint, dev::bigint, 
     dev::bigint, dev::eth::VM*, dev::eth::ExtVMFace const*)>;
 using plusAndMinus = std::pair<dev::u256, dev::u256>;
@@ -35,26 +37,35 @@ struct ResultExecute{
     CTransaction tx;
 };
 
+using UTXOCache = dev::FlatHashMap<dev::Address, Vin>;
+
+//Prior cache entry of each changed vin, boost::none if there was none
+using UTXOChanges = std::unordered_map<dev::Address, boost::optional<Vin>>;
+
 namespace abp{
     template <class DB>
-    dev::AddressHash commit(std::unordered_map<dev::Address, Vin> const& _cache, dev::eth::SecureTrieDB<dev::Address, DB>& _state, std::unordered_map<dev::Address, dev::eth::Account> const& _cacheAcc)
+    dev::AddressHash commit(UTXOCache const& _cache, UTXOChanges const& _changes, dev::eth::SecureTrieDB<dev::Address, DB>& _state)
     {
         dev::AddressHash ret;
-        for (auto const& i: _cache){
-            if(i.second.alive == 0){
-                 _state.remove(i.first);
+        for (auto const& c: _changes){
+            auto i = _cache.find(c.first);
+            if(i == _cache.end())
+                continue;
+            if(i->second.alive == 0){
+                 _state.remove(i->first);
             } else {
                 dev::RLPStream s(4);
-                s << i.second.hash << i.second.nVout << i.second.value << i.second.alive;
-                _state.insert(i.first, &s.out());
+                s << i->second.hash << i->second.nVout << i->second.value << i->second.alive;
+                _state.insert(i->first, &s.out());
             }
-            ret.insert(i.first);
+            ret.insert(i->first);
         }
         return ret;
     }
 }
 
 class CondensingTX;
+class CContractUndo;
 
 class AbpState : public dev::eth::State {
     
@@ -64,16 +75,28 @@ public:
 
     AbpState(dev::u256 const& _accountStartNonce, dev::OverlayDB const& _db, const std::string& _path, dev::eth::BaseState _bs = dev::eth::BaseState::PreExisting);
 
+    /** State over the given databases, e.g. in memory ones, instead of opening the vins database at a path */
+    AbpState(dev::u256 const& _accountStartNonce, dev::OverlayDB const& _db, dev::OverlayDB const& _dbUTXO, dev::eth::BaseState _bs = dev::eth::BaseState::PreExisting);
+
     ResultExecute execute(dev::eth::EnvInfo const& _envInfo, dev::eth::SealEngineFace const& _sealEngine, AbpTransaction const& _t, dev::eth::Permanence _p = dev::eth::Permanence::Committed, dev::eth::OnOpFunc const& _onOp = OnOpFunc());
 
-    void setRootUTXO(dev::h256 const& _r) { cacheUTXO.clear(); stateUTXO.setRoot(_r); }
+    void setRootUTXO(dev::h256 const& _r) { cacheUTXO.clear(); changedUTXO.clear(); stateUTXO.setRoot(_r); }
 
-    void setCacheUTXO(dev::Address const& address, Vin const& vin) { cacheUTXO.insert(std::make_pair(address, vin)); }
+    void setCacheUTXO(dev::Address const& address, Vin const& vin);
+
+    /** Drop the cached accounts and vins that have no uncommitted changes */
+    void clearCache();
 
     dev::h256 rootHashUTXO() const { return stateUTXO.root(); }
 
     std::unordered_map<dev::Address, Vin> vins() const; // temp
 
+    /** Record the prior values of everything committed from now on into _undo, nullptr stops recording */
+    void setStateUndo(CContractUndo* _undo);
+
+    /** Restore the values recorded in _undo, taking the state back to where recording started */
+    void applyUndo(CContractUndo const& _undo);
+
     dev::OverlayDB const& dbUtxo() const { return dbUTXO; }
 
 	dev::OverlayDB& dbUtxo() { return dbUTXO; }
@@ -90,6 +113,12 @@ private:
 
     Vin* vin(dev::Address const& _addr);
 
+    /** Keep the prior cache entry of _addr before it is first changed since the last commit */
+    void noteVinChange(dev::Address const& _addr);
+
+    /** Undo all changes to cacheUTXO since the last commit */
+    void revertUTXO();
+
     // void commit(CommitBehaviour _commitBehaviour);
 
     void kill(dev::Address _addr);
@@ -104,6 +133,8 @@ private:
 
     void printfErrorLog(const dev::eth::TransactionException er);
 
+    void recordUndo();
+
     dev::Address newAddress;
 
     std::vector<TransferInfo> transfers;
@@ -112,7 +143,18 @@ private:
 
 	dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> stateUTXO;
 
-	std::unordered_map<dev::Address, Vin> cacheUTXO;
+	UTXOCache cacheUTXO;
+
+    UTXOChanges changedUTXO;
+
+    CContractUndo* stateUndo = nullptr;
+
+    //Where each address and slot is in stateUndo, only their first prior value is kept
+    std::unordered_map<dev::Address, size_t> undoAccounts;
+
+    std::set<std::pair<dev::Address, dev::h256>> undoSlots;
+
+    dev::AddressHash undoUTXOs;
 };
 
 
@@ -144,6 +186,35 @@ struct TemporaryState{
 };
 
 
+/** Keeps what the contracts of one block read cached from one transaction to the next, and drops it once the block is done */
+struct StateCacheScope{
+    std::unique_ptr<AbpState>& globalStateRef;
+
+    StateCacheScope(std::unique_ptr<AbpState>& _globalStateRef) :
+        globalStateRef(_globalStateRef) { globalStateRef->clearCache(); }
+
+    ~StateCacheScope(){ globalStateRef->clearCache(); }
+
+    StateCacheScope() = delete;
+    StateCacheScope(const StateCacheScope&) = delete;
+    StateCacheScope& operator=(const StateCacheScope&) = delete;
+};
+
+
+struct StateUndoRecorder{
+    std::unique_ptr<AbpState>& globalStateRef;
+
+    StateUndoRecorder(std::unique_ptr<AbpState>& _globalStateRef, CContractUndo* undo) :
+        globalStateRef(_globalStateRef) { globalStateRef->setStateUndo(undo); }
+
+    ~StateUndoRecorder(){ globalStateRef->setStateUndo(nullptr); }
+
+    StateUndoRecorder() = delete;
+    StateUndoRecorder(const StateUndoRecorder&) = delete;
+    StateUndoRecorder& operator=(const StateUndoRecorder&) = delete;
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 class CondensingTX{
 
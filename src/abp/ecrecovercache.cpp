@@ -0,0 +1,150 @@
+#include <abp/ecrecovercache.h>
+
+#include <crypto/sha256.h>
+#include <cuckoocache.h>
+#include <random.h>
+#include <util.h>
+
+#include <libdevcore/FixedHash.h>
+#include <libethcore/Precompiled.h>
+
+#include <boost/thread.hpp>
+
+namespace {
+
+class CEcrecoverCache
+{
+private:
+    //! Entries are SHA256(nonce || ecrecover input):
+    uint256 nonce;
+    typedef CuckooCache::cache<EcrecoverCacheEntry, EcrecoverCacheHasher> map_type;
+    map_type setRecovered;
+    size_t nBytes = 0;
+    uint256 scheduleFingerprint;
+    boost::shared_mutex cs_ecrecovercache;
+
+public:
+    CEcrecoverCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    void ComputeEntry(EcrecoverCacheEntry& entry, const unsigned char* input, size_t size)
+    {
+        CSHA256().Write(nonce.begin(), 32).Write(input, size).Finalize(entry.key.begin());
+    }
+
+    bool Get(EcrecoverCacheEntry& entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_ecrecovercache);
+        return setRecovered.get(entry, false);
+    }
+
+    void Set(const EcrecoverCacheEntry& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_ecrecovercache);
+        setRecovered.insert(entry);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_ecrecovercache);
+        nBytes = n;
+        return setRecovered.setup_bytes(n);
+    }
+
+    void Clear()
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_ecrecovercache);
+        setRecovered.setup_bytes(nBytes);
+    }
+
+    //! Returns true (and records it) if the fingerprint differs from the last one seen.
+    bool SwapSchedule(const uint256& fingerprint)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_ecrecovercache);
+        if (scheduleFingerprint == fingerprint)
+            return false;
+        bool fFirst = scheduleFingerprint.IsNull();
+        scheduleFingerprint = fingerprint;
+        return !fFirst;
+    }
+};
+
+static CEcrecoverCache ecrecoverCache;
+
+//! Size of the ecrecover precompile input; shorter inputs are zero padded.
+static const size_t ECRECOVER_INPUT_SIZE = 128;
+
+std::pair<bool, dev::bytes> CachedEcrecover(const dev::eth::PrecompiledExecutor& recover, dev::bytesConstRef _in)
+{
+    unsigned char input[ECRECOVER_INPUT_SIZE] = {0};
+    memcpy(input, _in.data(), std::min(_in.size(), ECRECOVER_INPUT_SIZE));
+
+    EcrecoverCacheEntry entry;
+    ecrecoverCache.ComputeEntry(entry, input, sizeof(input));
+    if (ecrecoverCache.Get(entry)) {
+        if (!entry.recovered)
+            return {true, {}};
+        return {true, dev::bytes(entry.output.begin(), entry.output.end())};
+    }
+
+    std::pair<bool, dev::bytes> ret = recover(dev::bytesConstRef(input, sizeof(input)));
+    if (ret.first && (ret.second.empty() || ret.second.size() == entry.output.size())) {
+        entry.recovered = !ret.second.empty();
+        if (entry.recovered)
+            memcpy(entry.output.begin(), ret.second.data(), ret.second.size());
+        ecrecoverCache.Set(entry);
+    }
+    return ret;
+}
+
+uint256 ScheduleFingerprint(const dev::eth::EVMSchedule& s)
+{
+    // The DGP controlled fields, in the order of the gas schedule contract.
+    const uint64_t values[] = {s.tierStepGas[0], s.tierStepGas[1], s.tierStepGas[2], s.tierStepGas[3],
+                               s.tierStepGas[4], s.tierStepGas[5], s.tierStepGas[6], s.tierStepGas[7],
+                               s.expGas, s.expByteGas, s.sha3Gas, s.sha3WordGas, s.sloadGas, s.sstoreSetGas,
+                               s.sstoreResetGas, s.sstoreRefundGas, s.jumpdestGas, s.logGas, s.logDataGas,
+                               s.logTopicGas, s.createGas, s.callGas, s.callStipend, s.callValueTransferGas,
+                               s.callNewAccountGas, s.suicideRefundGas, s.memoryGas, s.quadCoeffDiv,
+                               s.createDataGas, s.txGas, s.txCreateGas, s.txDataZeroGas, s.txDataNonZeroGas,
+                               s.copyGas, s.extcodesizeGas, s.extcodecopyGas, s.balanceGas, s.suicideGas,
+                               s.maxCodeSize};
+    uint256 ret;
+    CSHA256().Write((const unsigned char*)values, sizeof(values)).Finalize(ret.begin());
+    return ret;
+}
+
+} // namespace
+
+void InitEcrecoverCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-ecrecovercachesize", DEFAULT_MAX_ECRECOVER_CACHE_SIZE)), MAX_MAX_ECRECOVER_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = ecrecoverCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for ecrecover cache, able to store %zu elements\n",
+            (nElems*sizeof(EcrecoverCacheEntry)) >>20, nMaxCacheSize>>20, nElems);
+
+    // Wrap the registered executor once; the chain params copy it when they are created.
+    static bool fWrapped = false;
+    if (!fWrapped) {
+        dev::eth::PrecompiledExecutor recover = dev::eth::PrecompiledRegistrar::executor("ecrecover");
+        dev::eth::PrecompiledRegistrar::registerPrecompiled("ecrecover", [recover](dev::bytesConstRef _in) {
+            return CachedEcrecover(recover, _in);
+        });
+        fWrapped = true;
+    }
+}
+
+void ClearEcrecoverCache()
+{
+    ecrecoverCache.Clear();
+}
+
+void UpdateEcrecoverCacheSchedule(const dev::eth::EVMSchedule& schedule)
+{
+    if (ecrecoverCache.SwapSchedule(ScheduleFingerprint(schedule))) {
+        LogPrintf("Gas schedule changed, clearing ecrecover cache\n");
+        ecrecoverCache.Clear();
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef ECRECOVERCACHE_H
+#define ECRECOVERCACHE_H
+
+#include <uint256.h>
+#include <libevmcore/EVMSchedule.h>
+
+#include <cstring>
+
+// Default ecrecover result cache size in MiB (about 75000 entries).
+static const unsigned int DEFAULT_MAX_ECRECOVER_CACHE_SIZE = 4;
+// Maximum ecrecover cache size allowed
+static const int64_t MAX_MAX_ECRECOVER_CACHE_SIZE = 1024;
+
+/**
+ * A memoized ecrecover result. Entries are keyed by
+ * SHA256(nonce || 128 byte precompile input); the recovered output rides
+ * along and is ignored by the comparison, so CuckooCache can store it.
+ */
+struct EcrecoverCacheEntry
+{
+    uint256 key;
+    uint256 output;
+    bool recovered = false;
+
+    bool operator==(const EcrecoverCacheEntry& other) const { return key == other.key; }
+};
+
+/** Hashes for CuckooCache, taken from the already salted key (see SignatureCacheHasher). */
+class EcrecoverCacheHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const EcrecoverCacheEntry& entry) const
+    {
+        static_assert(hash_select < 8, "EcrecoverCacheHasher only has 8 hashes available.");
+        uint32_t u;
+        std::memcpy(&u, entry.key.begin() + 4 * hash_select, 4);
+        return u;
+    }
+};
+
+/**
+ * Size the ecrecover cache from -ecrecovercachesize and route the ecrecover
+ * precompile through it. The cache is shared by every EVM execution in the
+ * process (mempool dry-runs, block assembly and ConnectBlock), so a signature
+ * verified once is not recovered again. Must run before the chain params
+ * capture the precompiled executors.
+ */
+void InitEcrecoverCache();
+
+/** Drop all cached recoveries. */
+void ClearEcrecoverCache();
+
+/**
+ * Called whenever the DGP gas schedule is applied to the seal engine; clears
+ * the cache when the schedule differs from the one last seen, so results
+ * never outlive the rules they were computed under.
+ */
+void UpdateEcrecoverCacheSchedule(const dev::eth::EVMSchedule& schedule);
+
+#endif
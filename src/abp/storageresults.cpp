@@ -52,6 +52,10 @@ std::vector<TransactionReceiptInfo> StorageResults::getResult(dev::h256 const& h
 	return result;
 }
 
+bool StorageResults::getCommittedResult(dev::h256 const& hashTx, std::vector<TransactionReceiptInfo>& result) const{
+    return readResult(hashTx, result);
+}
+
 void StorageResults::commitResults(){
     if(m_cache_result.size()){
 
@@ -94,7 +98,7 @@ void StorageResults::commitResults(){
     }
 }
 
-bool StorageResults::readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result){
+bool StorageResults::readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result) const{
 
     std::string value;
     std::string keyTemp = _key.hex();;
@@ -139,7 +143,7 @@ logEntriesSerializ StorageResults::logEntriesSerialization(dev::eth::LogEntries
 	return result;
 }
 
-dev::eth::LogEntries StorageResults::logEntriesDeserialize(logEntriesSerializ const& _logs){
+dev::eth::LogEntries StorageResults::logEntriesDeserialize(logEntriesSerializ const& _logs) const{
 	dev::eth::LogEntries result;
 	for(std::pair<dev::Address, std::pair<dev::h256s, dev::bytes>> i : _logs){
 		result.push_back(dev::eth::LogEntry(i.first, i.second.first, dev::bytes(i.second.second)));
@@ -47,6 +47,10 @@ public:
 
     std::vector<TransactionReceiptInfo> getResult(dev::h256 const& hashTx);
 
+    /** Read the receipts of a transaction from the database only, bypassing the
+     *  cache of the block being connected. Safe to call without cs_main. */
+    bool getCommittedResult(dev::h256 const& hashTx, std::vector<TransactionReceiptInfo>& result) const;
+
 	void commitResults();
 
     void clearCacheResult();
@@ -55,11 +59,11 @@ public:
 
 private:
 
-	bool readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result);
+	bool readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result) const;
 
 	logEntriesSerializ logEntriesSerialization(dev::eth::LogEntries const& _logs);
 
-	dev::eth::LogEntries logEntriesDeserialize(logEntriesSerializ const& _logs);
+	dev::eth::LogEntries logEntriesDeserialize(logEntriesSerializ const& _logs) const;
 
 	std::string path;
 
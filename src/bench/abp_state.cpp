@@ -0,0 +1,349 @@
+// Copyright (c) 2018 The Abp Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparams.h>
+#include <fs.h>
+#include <tinyformat.h>
+#include <validation.h>
+#include <abp/abpDGP.h>
+#include <abp/abpstate.h>
+#include <libdevcore/CommonData.h>
+#include <libethashseal/Ethash.h>
+#include <libethashseal/GenesisInfo.h>
+#include <libethereum/ChainParams.h>
+
+#include <leveldb/db.h>
+#include <leveldb/env.h>
+#include <memenv.h>
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const dev::Address SENDER("0101010101010101010101010101010101010101");
+const dev::u256 GAS_LIMIT = 10000000;
+
+/** A database kept in env, which has to outlive it */
+dev::OverlayDB OpenMemoryDB(leveldb::Env* env, const std::string& name)
+{
+    leveldb::Options options;
+    options.create_if_missing = true;
+    options.env = env;
+    leveldb::DB* db = nullptr;
+    leveldb::Status status = leveldb::DB::Open(options, name, &db);
+    assert(status.ok());
+    return dev::OverlayDB(db);
+}
+
+/**
+ * Init code that runs ctor and then returns runtime as the contract's code:
+ *
+ *   <ctor> PUSH1 len DUP1 PUSH1 offset PUSH1 0 CODECOPY PUSH1 0 RETURN <runtime>
+ */
+dev::bytes InitCode(const std::string& runtime, const std::string& ctor = "")
+{
+    return dev::fromHex(ctor + strprintf("60%02x8060%02x6000396000f3", runtime.size() / 2, ctor.size() / 2 + 11) + runtime);
+}
+
+/**
+ * Token with the balances in a mapping at slot 0, as solidity lays it out.
+ * The constructor gives the whole supply to the creator:
+ *
+ *   PUSH32 supply CALLER PUSH1 0 MSTORE PUSH1 0x40 PUSH1 0 SHA3 SSTORE
+ */
+const std::string TOKEN_CTOR = "7f" + std::string(64, 'f') + "33600052" "6040600020" "55";
+
+/**
+ * transfer(address to, uint256 value): moves value from the caller to to,
+ * logs Transfer(from, to, value) and returns true.
+ *
+ *   PUSH1 4 CALLDATALOAD PUSH1 0x24 CALLDATALOAD
+ *   CALLER PUSH1 0 MSTORE PUSH1 0 PUSH1 0x20 MSTORE PUSH1 0x40 PUSH1 0 SHA3
+ *   DUP1 SLOAD DUP3 DUP2 LT PUSH1 0x64 JUMPI DUP3 SWAP1 SUB SWAP1 SSTORE
+ *   DUP2 PUSH1 0 MSTORE PUSH1 0x40 PUSH1 0 SHA3
+ *   DUP1 SLOAD DUP3 ADD SWAP1 SSTORE
+ *   PUSH1 0 MSTORE CALLER PUSH32 Transfer PUSH1 0x20 PUSH1 0 LOG3
+ *   PUSH1 1 PUSH1 0 MSTORE PUSH1 0x20 PUSH1 0 RETURN
+ *   0x64: JUMPDEST INVALID
+ */
+const std::string TOKEN = "600435" "602435"
+    "33600052" "6000602052" "6040600020"
+    "8054" "8281" "10" "606457" "829003" "9055"
+    "81600052" "6040600020"
+    "8054" "8201" "9055"
+    "600052" "33" "7fddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef" "60206000a3"
+    "6001600052" "60206000f3"
+    "5b" "fe";
+
+/**
+ * Writes the first call data word to 64 slots:
+ *
+ *   PUSH1 64 JUMPDEST PUSH1 0 CALLDATALOAD DUP2 SSTORE PUSH1 1 SWAP1 SUB DUP1 PUSH1 2 JUMPI STOP
+ */
+const std::string STORAGE_LOOP = "6040" "5b" "600035" "81" "55" "6001900380600257" "00";
+
+/**
+ * Hashes the first memory word into itself 256 times:
+ *
+ *   PUSH2 256 JUMPDEST PUSH1 0x40 PUSH1 0 SHA3 PUSH1 0 MSTORE PUSH1 1 SWAP1 SUB DUP1 PUSH1 3 JUMPI STOP
+ */
+const std::string SHA3_LOOP = "610100" "5b" "6040600020" "600052" "6001900380600357" "00";
+
+/**
+ * Increments slot 0, the end of the call chain:
+ *
+ *   PUSH1 0 SLOAD PUSH1 1 ADD PUSH1 0 SSTORE STOP
+ */
+const std::string COUNTER = "600054" "600101" "600055" "00";
+
+/**
+ * Calls the next contract with all but 10000 of the gas left:
+ *
+ *   PUSH1 0 PUSH1 0 PUSH1 0 PUSH1 0 PUSH1 0 PUSH20 next PUSH2 10000 GAS SUB CALL POP STOP
+ */
+std::string Forwarder(const dev::Address& next)
+{
+    return "60006000600060006000" "73" + next.hex() + "6127105a03" "f1" "50" "00";
+}
+
+/** An AbpState over in-memory databases, executing like ByteCodeExec does */
+class BenchAbpState
+{
+public:
+    BenchAbpState() :
+        env(leveldb::NewMemEnv(leveldb::Env::Default())),
+        state(dev::u256(0), OpenMemoryDB(env.get(), "/state"), OpenMemoryDB(env.get(), "/stateUTXO"), dev::eth::BaseState::Empty)
+    {
+        // execute() looks up the consensus params when a transaction fails
+        SelectParams(CBaseChainParams::MAIN);
+        dev::eth::Ethash::init();
+        dev::eth::ChainParams cp((dev::eth::genesisInfo(dev::eth::Network::abpMainNetwork)));
+        sealEngine.reset(cp.createSealEngine());
+        state.setRootUTXO(dev::sha3(dev::rlp("")));
+
+        envInfo.setNumber(100000);
+        envInfo.setGasLimit(DEFAULT_BLOCK_GAS_LIMIT_DGP);
+        envInfo.setLastHashes(dev::eth::LastHashes(256));
+        envInfo.setAuthor(dev::Address("abababababababababababababababababababab"));
+    }
+
+    /** A transaction from SENDER, each with its own hash so that created contracts get new addresses */
+    AbpTransaction MakeTransaction(const dev::bytes& data, const dev::Address& to = dev::Address())
+    {
+        AbpTransaction tx;
+        if (to == dev::Address()) {
+            tx = AbpTransaction(0, 1, GAS_LIMIT, data, 0);
+        } else {
+            tx = AbpTransaction(0, 1, GAS_LIMIT, to, data, 0);
+        }
+        tx.forceSender(SENDER);
+        tx.setHashWith(dev::sha3(dev::h256(dev::u256(++nTransactions))));
+        tx.setNVout(0);
+        tx.setVersion(VersionVM::GetEVMDefault());
+        return tx;
+    }
+
+    /** Execute tx and commit the state to the databases, as one transaction block */
+    ResultExecute Execute(const AbpTransaction& tx)
+    {
+        ResultExecute res = state.execute(envInfo, *sealEngine, tx);
+        assert(res.execRes.excepted == dev::eth::TransactionException::None);
+        Commit();
+        return res;
+    }
+
+    dev::Address Deploy(const std::string& runtime, const std::string& ctor = "")
+    {
+        return Execute(MakeTransaction(InitCode(runtime, ctor))).execRes.newAddress;
+    }
+
+    void Commit()
+    {
+        state.db().commit();
+        state.dbUtxo().commit();
+        sealEngine->deleteAddresses.clear();
+    }
+
+    std::unique_ptr<leveldb::Env> env;
+    AbpState state;
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine;
+    dev::eth::EnvInfo envInfo;
+    uint64_t nTransactions = 0;
+};
+
+/** Call data of transfer(to, value) */
+dev::bytes TransferData(const dev::Address& to, uint64_t value)
+{
+    dev::bytes data = dev::fromHex("a9059cbb");
+    dev::bytes word = dev::h256(to, dev::h256::AlignRight).asBytes();
+    data.insert(data.end(), word.begin(), word.end());
+    word = dev::h256(dev::u256(value)).asBytes();
+    data.insert(data.end(), word.begin(), word.end());
+    return data;
+}
+
+} // namespace
+
+// Token transfers to 1000 recipients in turn, the common contract call.
+static void AbpState_TokenTransfer(benchmark::State& state)
+{
+    BenchAbpState bench;
+    const dev::Address token = bench.Deploy(TOKEN, TOKEN_CTOR);
+    unsigned n = 0;
+    while (state.KeepRunning()) {
+        bench.Execute(bench.MakeTransaction(TransferData(dev::Address(0x10000 + n % 1000), 1), token));
+        n++;
+    }
+}
+
+// 64 slots rewritten with a new value by every call.
+static void AbpState_StorageWrites(benchmark::State& state)
+{
+    BenchAbpState bench;
+    const dev::Address contract = bench.Deploy(STORAGE_LOOP);
+    uint64_t n = 0;
+    while (state.KeepRunning()) {
+        bench.Execute(bench.MakeTransaction(dev::h256(dev::u256(++n)).asBytes(), contract));
+    }
+}
+
+static void AbpState_SHA3Loop(benchmark::State& state)
+{
+    BenchAbpState bench;
+    const dev::Address contract = bench.Deploy(SHA3_LOOP);
+    while (state.KeepRunning()) {
+        bench.Execute(bench.MakeTransaction(dev::bytes(), contract));
+    }
+}
+
+// A new token contract by every transaction, constructor included.
+static void AbpState_Create(benchmark::State& state)
+{
+    BenchAbpState bench;
+    const dev::bytes code = InitCode(TOKEN, TOKEN_CTOR);
+    while (state.KeepRunning()) {
+        bench.Execute(bench.MakeTransaction(code));
+    }
+}
+
+// Eight contracts calling each other, the last one updating its storage.
+static void AbpState_NestedCalls(benchmark::State& state)
+{
+    BenchAbpState bench;
+    dev::Address next = bench.Deploy(COUNTER);
+    for (int i = 0; i < 7; i++) {
+        next = bench.Deploy(Forwarder(next));
+    }
+    while (state.KeepRunning()) {
+        bench.Execute(bench.MakeTransaction(dev::bytes(), next));
+    }
+}
+
+// Ten contracts each sending to the next one and to a pubkeyhash address.
+static void Abp_CondensingTX(benchmark::State& state)
+{
+    BenchAbpState bench;
+    std::vector<TransferInfo> transfers;
+    for (unsigned i = 0; i < 10; i++) {
+        const dev::Address contract(0x1000 + i);
+        bench.state.createContract(contract);
+        bench.state.setNewCode(contract, dev::bytes{0});
+        bench.state.setCacheUTXO(contract, Vin{dev::sha3(contract), 0, 1000000, 1});
+        transfers.push_back({contract, dev::Address(0x1000 + (i + 1) % 10), 1000});
+        transfers.push_back({contract, dev::Address(0x2000 + i), 500});
+    }
+    bench.state.commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    const AbpTransaction tx = bench.MakeTransaction(dev::bytes(), dev::Address(0x1000));
+    while (state.KeepRunning()) {
+        CondensingTX ctx(&bench.state, transfers, tx);
+        CTransaction condensed = ctx.createCondensingTX();
+        assert(condensed.vout.size() == 20);
+        ctx.createVin(condensed);
+    }
+}
+
+// Receipts of a block of 100 transactions with one log each.
+static void Abp_StorageResults(benchmark::State& state)
+{
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("bench_abp_%%%%-%%%%-%%%%");
+    fs::create_directories(path);
+    {
+        StorageResults results(path.string());
+        TransactionReceiptInfo receipt;
+        receipt.blockNumber = 100000;
+        receipt.transactionIndex = 1;
+        receipt.from = SENDER;
+        receipt.to = dev::Address(0x1000);
+        receipt.cumulativeGasUsed = 100000;
+        receipt.gasUsed = 50000;
+        receipt.logs.push_back(dev::eth::LogEntry(receipt.to, {dev::sha3(receipt.to), dev::h256(receipt.from, dev::h256::AlignRight), dev::h256(receipt.to, dev::h256::AlignRight)}, dev::bytes(32)));
+        receipt.excepted = dev::eth::TransactionException::None;
+        uint64_t n = 0;
+        while (state.KeepRunning()) {
+            for (int i = 0; i < 100; i++) {
+                std::vector<TransactionReceiptInfo> result(1, receipt);
+                results.addResult(dev::sha3(dev::h256(dev::u256(++n))), result);
+            }
+            results.commitResults();
+        }
+    }
+    fs::remove_all(path);
+}
+
+// 1000 new keys into a growing trie, then written to the database.
+static void Abp_TrieCommit(benchmark::State& state)
+{
+    std::unique_ptr<leveldb::Env> env(leveldb::NewMemEnv(leveldb::Env::Default()));
+    dev::OverlayDB db = OpenMemoryDB(env.get(), "/trie");
+    dev::eth::SecureTrieDB<dev::h256, dev::OverlayDB> trie(&db);
+    trie.init();
+    uint64_t n = 0;
+    while (state.KeepRunning()) {
+        for (int i = 0; i < 1000; i++, n++) {
+            trie.insert(dev::h256(dev::u256(n)), dev::rlp(dev::u256(n)));
+        }
+        db.commit();
+    }
+}
+
+// The block gas limit with eight parameter changes, read through the state
+// trie as at the start of a block.
+static void Abp_DGPReads(benchmark::State& state)
+{
+    BenchAbpState bench;
+    const dev::u256 paramsInstance(dev::sha3(dev::h256()));
+    bench.state.createContract(BlockGasLimitDGP);
+    bench.state.setNewCode(BlockGasLimitDGP, dev::bytes{0});
+    bench.state.setStorage(BlockGasLimitDGP, 0, 8);
+    for (unsigned i = 0; i < 8; i++) {
+        const dev::Address params(0x3000 + i);
+        bench.state.createContract(params);
+        bench.state.setNewCode(params, dev::bytes{0});
+        bench.state.setStorage(params, 0, 50000000 + i);
+        bench.state.setStorage(BlockGasLimitDGP, paramsInstance + 2 * i, 1000 * i);
+        bench.state.setStorage(BlockGasLimitDGP, paramsInstance + 2 * i + 1, dev::u256(dev::u160(params)));
+    }
+    bench.state.commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    bench.Commit();
+    while (state.KeepRunning()) {
+        bench.state.clearCache();
+        AbpDGP abpDGP(&bench.state, false);
+        uint64_t blockGasLimit = abpDGP.getBlockGasLimit(100000);
+        assert(blockGasLimit == 50000007);
+    }
+}
+
+BENCHMARK(AbpState_TokenTransfer, 7000);
+BENCHMARK(AbpState_StorageWrites, 700);
+BENCHMARK(AbpState_SHA3Loop, 2000);
+BENCHMARK(AbpState_Create, 1500);
+BENCHMARK(AbpState_NestedCalls, 5000);
+BENCHMARK(Abp_CondensingTX, 15000);
+BENCHMARK(Abp_StorageResults, 250);
+BENCHMARK(Abp_TrieCommit, 12);
+BENCHMARK(Abp_DGPReads, 4000);
@@ -0,0 +1,361 @@
+// Copyright (c) 2015-2017 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <chainparams.h>
+#include <chainparamsbase.h>
+#include <consensus/validation.h>
+#include <crypto/sha256.h>
+#include <fs.h>
+#include <key.h>
+#include <pubkey.h>
+#include <random.h>
+#include <scheduler.h>
+#include <script/sigcache.h>
+#include <abp/ecrecovercache.h>
+#include <txdb.h>
+#include <txmempool.h>
+#include <univalue.h>
+#include <util.h>
+#include <utilstrencodings.h>
+#include <validation.h>
+#include <validationinterface.h>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <iostream>
+#include <memory>
+
+static const char* DEFAULT_REPLAY_PRINTER = "console";
+
+/** One point of a -par/-dbcache sweep */
+struct ReplayConfig {
+    int nPar;
+    int64_t nDbCache;
+};
+
+struct ReplayResult {
+    ReplayConfig config;
+    int nFromHeight;
+    int nToHeight;
+    ConnectBlockStats stats;
+};
+
+static std::vector<int64_t> ParseSweep(const std::string& strArg, int64_t nDefault)
+{
+    std::vector<int64_t> values;
+    std::vector<std::string> strValues;
+    boost::split(strValues, gArgs.GetArg(strArg, i64tostr(nDefault)), boost::is_any_of(","));
+    for (const std::string& value : strValues) {
+        int64_t n;
+        if (!ParseInt64(value, &n))
+            throw std::runtime_error(strprintf("Invalid value for %s: %s", strArg, value));
+        values.push_back(n);
+    }
+    return values;
+}
+
+/**
+ * Copy what connecting blocks reads and writes: the block index, the coins
+ * database and the contract state. Block and undo files are only read, they
+ * are hard linked where the file system allows it.
+ */
+static void CopyChainState(const fs::path& from, const fs::path& to)
+{
+    fs::create_directories(to / "blocks");
+    for (fs::directory_iterator it(from / "blocks"); it != fs::directory_iterator(); ++it) {
+        const fs::path& path = it->path();
+        if (fs::is_directory(path))
+            continue;
+        try {
+            fs::create_hard_link(path, to / "blocks" / path.filename());
+        } catch (const fs::filesystem_error&) {
+            fs::copy_file(path, to / "blocks" / path.filename());
+        }
+    }
+    for (const char* dir : {"blocks/index", "chainstate", "stateAbp"}) {
+        fs::create_directories(to / dir);
+        for (fs::directory_iterator it(from / dir); it != fs::directory_iterator(); ++it)
+            fs::copy_file(it->path(), to / dir / it->path().filename());
+    }
+}
+
+/** Open the copied databases the way AppInitMain does, without -reindex */
+static bool LoadChainState(const CChainParams& chainparams, int64_t nDbCache)
+{
+    int64_t nTotalCache = std::min(std::max(nDbCache, nMinDbCache), nMaxDbCache) << 20;
+    int64_t nBlockTreeDBCache = std::min(nTotalCache / 8, (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxBlockDBAndTxIndexCache : nMaxBlockDBCache) << 20);
+    nTotalCache -= nBlockTreeDBCache;
+    int64_t nCoinDBCache = std::min(std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23)), nMaxCoinsDBCache << 20);
+    nTotalCache -= nCoinDBCache;
+    nCoinCacheUsage = nTotalCache;
+
+    pblocktree.reset(new CBlockTreeDB(nBlockTreeDBCache, false, false));
+    if (!LoadBlockIndex(chainparams) || !LoadGenesisBlock(chainparams))
+        return false;
+    pcoinsdbview.reset(new CCoinsViewDB(nCoinDBCache, false, false));
+    if (!ReplayBlocks(chainparams, pcoinsdbview.get()))
+        return false;
+    pcoinsTip.reset(new CCoinsViewCache(pcoinsdbview.get()));
+    if (pcoinsTip->GetBestBlock().IsNull() || !LoadChainTip(chainparams))
+        return false;
+
+    fGettingValuesDGP = true;
+    dev::eth::Ethash::init();
+    const std::string dirAbp((GetDataDir() / "stateAbp").string());
+    const dev::h256 hashDB(dev::sha3(dev::rlp("")));
+    globalState = std::unique_ptr<AbpState>(new AbpState(dev::u256(0), AbpState::openDB(dirAbp, hashDB, dev::WithExisting::Trust), dirAbp, dev::eth::BaseState::PreExisting));
+    dev::eth::ChainParams cp((dev::eth::genesisInfo(dev::eth::Network::abpMainNetwork)));
+    globalSealEngine = std::unique_ptr<dev::eth::SealEngineFace>(cp.createSealEngine());
+    pstorageresult.reset(new StorageResults(dirAbp));
+    globalState->setRoot(uintToh256(chainActive.Tip()->hashStateRoot));
+    globalState->setRootUTXO(uintToh256(chainActive.Tip()->hashUTXORoot));
+    return true;
+}
+
+static void UnloadChainState()
+{
+    LOCK(cs_main);
+    UnloadBlockIndex();
+    pcoinsTip.reset();
+    pcoinsdbview.reset();
+    pblocktree.reset();
+    pstorageresult.reset();
+    globalState.reset();
+    globalSealEngine.reset();
+}
+
+/**
+ * Bring the chain to nFrom - 1 and have ActivateBestChain stop at nTo. The
+ * block at nFrom is marked invalid while the blocks above it are disconnected
+ * through their undo data, or the ones below it connected, and the block
+ * after nTo stays marked invalid.
+ */
+static bool PrepareRange(const CChainParams& chainparams, int& nFrom, int& nTo)
+{
+    CValidationState state;
+    CBlockIndex* pindexFrom;
+    {
+        LOCK(cs_main);
+        if (nFrom < 0)
+            nFrom = chainActive.Height() + 1;
+        if (nTo < 0 || nTo > pindexBestHeader->nHeight)
+            nTo = pindexBestHeader->nHeight;
+        if (nFrom < 1 || nFrom > nTo)
+            return error("Nothing to replay from height %d to %d, the best header is at %d", nFrom, nTo, pindexBestHeader->nHeight);
+        pindexFrom = pindexBestHeader->GetAncestor(nFrom);
+        if (!InvalidateBlock(state, chainparams, pindexFrom))
+            return error("Failed to rewind to height %d: %s", nFrom - 1, FormatStateMessage(state));
+    }
+    if (!ActivateBestChain(state, chainparams))
+        return error("Failed to reach height %d: %s", nFrom - 1, FormatStateMessage(state));
+
+    LOCK(cs_main);
+    if (chainActive.Height() != nFrom - 1)
+        return error("Failed to reach height %d, the chain state is at %d", nFrom - 1, chainActive.Height());
+    ResetBlockFailureFlags(pindexFrom);
+    if (nTo < pindexBestHeader->nHeight && !InvalidateBlock(state, chainparams, pindexBestHeader->GetAncestor(nTo + 1)))
+        return error("Failed to end the replay at height %d: %s", nTo, FormatStateMessage(state));
+    mempool.clear();
+    return true;
+}
+
+static bool RunReplay(const CChainParams& chainparams, const fs::path& pathSource, ReplayResult& result)
+{
+    fs::path pathReplay = GetDataDir();
+    CopyChainState(pathSource, pathReplay);
+
+    nScriptCheckThreads = result.config.nPar;
+    if (nScriptCheckThreads <= 0)
+        nScriptCheckThreads += GetNumCores();
+    if (nScriptCheckThreads <= 1)
+        nScriptCheckThreads = 0;
+    else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
+        nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
+    boost::thread_group threadGroup;
+    for (int i = 0; i < nScriptCheckThreads - 1; i++) {
+        threadGroup.create_thread(&ThreadScriptCheck);
+        threadGroup.create_thread(&ThreadCoinsPrefetch);
+    }
+
+    bool fOk = LoadChainState(chainparams, result.config.nDbCache) &&
+        PrepareRange(chainparams, result.nFromHeight, result.nToHeight);
+    if (fOk) {
+        CValidationState state;
+        {
+            LOCK(cs_main);
+            ResetConnectBlockStats();
+        }
+        int64_t nTimeStart = GetTimeMicros();
+        fOk = ActivateBestChain(state, chainparams);
+        int64_t nTimeFlush = GetTimeMicros();
+        FlushStateToDisk();
+        int64_t nTimeEnd = GetTimeMicros();
+
+        LOCK(cs_main);
+        result.stats = GetConnectBlockStats();
+        result.stats.nTimeFlush += nTimeEnd - nTimeFlush;
+        result.stats.nTimeTotal = nTimeEnd - nTimeStart;
+        if (fOk && chainActive.Height() != result.nToHeight)
+            fOk = error("Replay stopped at height %d: %s", chainActive.Height(), FormatStateMessage(state));
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+    UnloadChainState();
+    fs::remove_all(pathReplay);
+    return fOk;
+}
+
+static void PrintConsole(const ReplayResult& result)
+{
+    const ConnectBlockStats& stats = result.stats;
+    double seconds = stats.nTimeTotal * 0.000001;
+    std::cout << strprintf("par=%d dbcache=%d: blocks %d to %d, %d transactions, %u gas in %.3fs (%.1f tx/s, %.0f gas/s)\n",
+        result.config.nPar, result.config.nDbCache, result.nFromHeight, result.nToHeight, stats.nTransactions, stats.nGasUsed,
+        seconds, seconds > 0 ? stats.nTransactions / seconds : 0, seconds > 0 ? stats.nGasUsed / seconds : 0);
+    std::cout << strprintf("  %-14s %10.3fs\n", "read", stats.nTimeReadFromDisk * 0.000001);
+    std::cout << strprintf("  %-14s %10.3fs\n", "prefetch", stats.nTimePrefetch * 0.000001);
+    std::cout << strprintf("  %-14s %10.3fs\n", "scripts", stats.nTimeScriptChecks * 0.000001);
+    std::cout << strprintf("  %-14s %10.3fs\n", "evm", stats.nTimeEVM * 0.000001);
+    std::cout << strprintf("  %-14s %10.3fs\n", "trie commit", stats.nTimeTrieCommit * 0.000001);
+    std::cout << strprintf("  %-14s %10.3fs\n", "receipts", stats.nTimeReceipts * 0.000001);
+    std::cout << strprintf("  %-14s %10.3fs\n", "utxo flush", stats.nTimeFlush * 0.000001);
+}
+
+static UniValue ResultToJSON(const ReplayResult& result)
+{
+    const ConnectBlockStats& stats = result.stats;
+    double seconds = stats.nTimeTotal * 0.000001;
+    UniValue stages(UniValue::VOBJ);
+    stages.pushKV("read", stats.nTimeReadFromDisk * 0.000001);
+    stages.pushKV("prefetch", stats.nTimePrefetch * 0.000001);
+    stages.pushKV("scripts", stats.nTimeScriptChecks * 0.000001);
+    stages.pushKV("evm", stats.nTimeEVM * 0.000001);
+    stages.pushKV("trie_commit", stats.nTimeTrieCommit * 0.000001);
+    stages.pushKV("receipts", stats.nTimeReceipts * 0.000001);
+    stages.pushKV("utxo_flush", stats.nTimeFlush * 0.000001);
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("par", result.config.nPar);
+    obj.pushKV("dbcache", result.config.nDbCache);
+    obj.pushKV("from", result.nFromHeight);
+    obj.pushKV("to", result.nToHeight);
+    obj.pushKV("blocks", stats.nBlocks);
+    obj.pushKV("transactions", stats.nTransactions);
+    obj.pushKV("gas", (uint64_t)stats.nGasUsed);
+    obj.pushKV("seconds", seconds);
+    obj.pushKV("tx_per_second", seconds > 0 ? stats.nTransactions / seconds : 0);
+    obj.pushKV("gas_per_second", seconds > 0 ? stats.nGasUsed / seconds : 0);
+    obj.pushKV("stages", stages);
+    return obj;
+}
+
+int
+main(int argc, char** argv)
+{
+    gArgs.ParseParameters(argc, argv);
+
+    if (gArgs.IsArgSet("-?") || gArgs.IsArgSet("-h") || gArgs.IsArgSet("-help")) {
+        std::cout << HelpMessageGroup(_("Options:"))
+                  << HelpMessageOpt("-?", _("Print this help message and exit"))
+                  << HelpMessageOpt("-datadir=<dir>", _("Data directory to replay blocks from, it is not modified. The node using it must be stopped"))
+                  << HelpMessageOpt("-replaydir=<dir>", _("Directory to copy the chain state to for each run (default: a new temporary directory)"))
+                  << HelpMessageOpt("-from=<n>", _("First block height to replay, the chain state is rewound or advanced to the block before it first (default: the block after the chain state's tip)"))
+                  << HelpMessageOpt("-to=<n>", _("Last block height to replay (default: the best header's)"))
+                  << HelpMessageOpt("-par=<n>[,<n>...]", strprintf(_("Script verification threads, one run for each value (default: %d)"), DEFAULT_SCRIPTCHECK_THREADS))
+                  << HelpMessageOpt("-dbcache=<n>[,<n>...]", strprintf(_("Database cache size in megabytes, one run for each value and -par (default: %d)"), nDefaultDbCache))
+                  << HelpMessageOpt("-printtoconsole", _("Print the node's log, with -debug=bench timings of each block, to the console"))
+                  << HelpMessageOpt("-printer=(console|json)", strprintf(_("Choose printer format. console: print timings to console. json: print one JSON array of all runs (default: %s)"), DEFAULT_REPLAY_PRINTER))
+                  << HelpMessageGroup(_("Chain selection options:"))
+                  << HelpMessageOpt("-testnet", _("Use the test chain"))
+                  << HelpMessageOpt("-regtest", _("Use the regression test chain"));
+        return 0;
+    }
+
+    SHA256AutoDetect();
+    RandomInit();
+    ECC_Start();
+    SetupEnvironment();
+    fPrintToDebugLog = false; // don't want to write to debug.log file
+    fPrintToConsole = gArgs.GetBoolArg("-printtoconsole", false);
+    for (const std::string& cat : gArgs.GetArgs("-debug")) {
+        uint32_t flag = 0;
+        if (GetLogCategory(&flag, &cat))
+            logCategories |= flag;
+    }
+
+    int nRet = EXIT_SUCCESS;
+    try {
+        SelectParams(ChainNameFromCommandLine());
+        const CChainParams& chainparams = Params();
+        ECCVerifyHandle verifyHandle;
+        InitSignatureCache();
+        InitScriptExecutionCache();
+        InitEcrecoverCache();
+
+        if (!fs::is_directory(GetDataDir(false)))
+            throw std::runtime_error(strprintf("Specified data directory \"%s\" does not exist", gArgs.GetArg("-datadir", "")));
+        fs::path pathSource = GetDataDir();
+        if (!LockDirectory(pathSource, ".lock", true))
+            throw std::runtime_error(strprintf("Cannot obtain a lock on %s, stop the node using it first", pathSource.string()));
+        for (const char* dir : {"blocks/index", "chainstate", "stateAbp"})
+            if (!fs::is_directory(pathSource / dir))
+                throw std::runtime_error(strprintf("%s has no %s directory", pathSource.string(), dir));
+        fs::path pathReplayRoot = gArgs.IsArgSet("-replaydir") ? fs::absolute(gArgs.GetArg("-replaydir", "")) :
+            fs::temp_directory_path() / strprintf("bench_replay_%lu_%i", (unsigned long)GetTime(), (int)GetRand(100000));
+        fs::create_directories(pathReplayRoot);
+        gArgs.ForceSetArg("-datadir", pathReplayRoot.string());
+        ClearDatadirCache();
+
+        std::vector<ReplayConfig> configs;
+        for (int64_t nDbCache : ParseSweep("-dbcache", nDefaultDbCache))
+            for (int64_t nPar : ParseSweep("-par", DEFAULT_SCRIPTCHECK_THREADS))
+                configs.push_back(ReplayConfig{(int)nPar, nDbCache});
+
+        // ActivateBestChain waits on the validation interface queue
+        CScheduler scheduler;
+        boost::thread schedulerThread(boost::bind(&CScheduler::serviceQueue, &scheduler));
+        GetMainSignals().RegisterBackgroundSignalScheduler(scheduler);
+
+        std::string printer = gArgs.GetArg("-printer", DEFAULT_REPLAY_PRINTER);
+        UniValue results(UniValue::VARR);
+        try {
+            for (const ReplayConfig& config : configs) {
+                ReplayResult result{config, (int)gArgs.GetArg("-from", -1), (int)gArgs.GetArg("-to", -1), ConnectBlockStats()};
+                if (!RunReplay(chainparams, pathSource, result)) {
+                    std::cerr << strprintf("Replay with -par=%d -dbcache=%d failed, see the log printed with -printtoconsole\n", config.nPar, config.nDbCache);
+                    nRet = EXIT_FAILURE;
+                    break;
+                }
+                if (printer == "json")
+                    results.push_back(ResultToJSON(result));
+                else
+                    PrintConsole(result);
+            }
+        } catch (const std::exception& e) {
+            // Still stop the scheduler thread below
+            std::cerr << "Error: " << e.what() << std::endl;
+            nRet = EXIT_FAILURE;
+        }
+        if (printer == "json")
+            std::cout << results.write(2) << std::endl;
+
+        schedulerThread.interrupt();
+        schedulerThread.join();
+        GetMainSignals().FlushBackgroundCallbacks();
+        GetMainSignals().UnregisterBackgroundSignalScheduler();
+        if (!gArgs.IsArgSet("-replaydir"))
+            fs::remove_all(pathReplayRoot);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        nRet = EXIT_FAILURE;
+    }
+
+    ECC_Stop();
+    return nRet;
+}
@@ -52,6 +52,21 @@ static void SHA256_32b(benchmark::State& state)
     }
 }
 
+static void SHA256D64_1024(benchmark::State& state, sha256_implementation::UseImplementation impl)
+{
+    SHA256AutoDetect(impl);
+    std::vector<uint8_t> in(64 * 1024, 0);
+    while (state.KeepRunning()) {
+        SHA256D64(in.data(), in.data(), 1024);
+    }
+    SHA256AutoDetect();
+}
+
+static void SHA256D64_1024_STANDARD(benchmark::State& state) { SHA256D64_1024(state, sha256_implementation::STANDARD); }
+static void SHA256D64_1024_SSE4(benchmark::State& state) { SHA256D64_1024(state, sha256_implementation::USE_SSE4); }
+static void SHA256D64_1024_AVX2(benchmark::State& state) { SHA256D64_1024(state, sha256_implementation::USE_SSE4_AND_AVX2); }
+static void SHA256D64_1024_SHANI(benchmark::State& state) { SHA256D64_1024(state, sha256_implementation::USE_SSE4_AND_SHANI); }
+
 static void SHA512(benchmark::State& state)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -93,6 +108,10 @@ BENCHMARK(SHA256, 340);
 BENCHMARK(SHA512, 330);
 
 BENCHMARK(SHA256_32b, 4700 * 1000);
+BENCHMARK(SHA256D64_1024_STANDARD, 7400);
+BENCHMARK(SHA256D64_1024_SSE4, 7400);
+BENCHMARK(SHA256D64_1024_AVX2, 7400);
+BENCHMARK(SHA256D64_1024_SHANI, 7400);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
@@ -0,0 +1,270 @@
+static unsigned const char blockbench[] = {
+0x00, 0x00, 0x00, 0x20, 0xe5, 0x51, 0x75, 0x94, 
+0xd5, 0x0f, 0x39, 0xc1, 0x4b, 0x60, 0xbd, 0x57, 
+0xf8, 0x7e, 0x69, 0xe9, 0x56, 0x97, 0x29, 0x15, 
+0x58, 0xf4, 0x61, 0x85, 0x3a, 0x24, 0xd0, 0x7f, 
+0xbd, 0x74, 0x64, 0x2b, 0x2e, 0x8a, 0xc0, 0xe2, 
+0x08, 0x42, 0x86, 0xd4, 0x3f, 0x18, 0xd3, 0x6a, 
+0x92, 0xda, 0x0d, 0x14, 0xa5, 0x02, 0xa6, 0xee, 
+0xd5, 0x83, 0x35, 0xdb, 0xb4, 0xdd, 0xae, 0xde, 
+0xbf, 0xd7, 0xa0, 0x19, 0x70, 0x39, 0x06, 0x5a, 
+0x78, 0xb6, 0x07, 0x1a, 0x00, 0x00, 0x00, 0x00, 
+0x3b, 0xf2, 0x54, 0x33, 0x95, 0x05, 0x2a, 0xeb, 
+0x01, 0x32, 0x0b, 0x3f, 0x9b, 0xb2, 0x22, 0xaa, 
+0x2f, 0x50, 0xc0, 0x8d, 0xcc, 0xaa, 0x55, 0xfe, 
+0x73, 0x1c, 0x0f, 0x41, 0x45, 0x2c, 0x39, 0xca, 
+0x93, 0xb3, 0x9d, 0x18, 0x0a, 0x4d, 0x4b, 0x8c, 
+0xa5, 0x94, 0x9b, 0xd2, 0x5f, 0xfe, 0x3d, 0x1e, 
+0x6a, 0xf1, 0x3a, 0xfd, 0xf2, 0x62, 0x8c, 0x9c, 
+0xc0, 0x3e, 0xf4, 0xf2, 0x45, 0xcc, 0xba, 0xb5, 
+0xb8, 0x77, 0xf4, 0x1a, 0x4e, 0xf5, 0x58, 0x63, 
+0x23, 0xb0, 0xfc, 0xc9, 0xff, 0x9b, 0xd9, 0x83, 
+0xfe, 0xee, 0xb6, 0xbc, 0x90, 0xce, 0x85, 0xfc, 
+0xe0, 0x49, 0x57, 0x44, 0xd5, 0xa7, 0x48, 0x7b, 
+0x07, 0x00, 0x00, 0x00, 0x47, 0x30, 0x45, 0x02, 
+0x21, 0x00, 0xfd, 0xc1, 0x42, 0xc2, 0x29, 0x1d, 
+0x09, 0x45, 0xb9, 0xb5, 0x53, 0xd7, 0xd4, 0xb6, 
+0x24, 0x8a, 0x78, 0xaa, 0x4e, 0x7f, 0x58, 0xcb, 
+0xb8, 0xd8, 0x17, 0x28, 0x94, 0xd0, 0xf0, 0xeb, 
+0x3d, 0xd2, 0x02, 0x20, 0x42, 0xc0, 0xb0, 0x18, 
+0xb4, 0x49, 0x7a, 0xda, 0x88, 0x42, 0xb5, 0x17, 
+0x50, 0xb8, 0xaa, 0x7d, 0x4c, 0x63, 0x9e, 0x0a, 
+0x64, 0x80, 0x9f, 0x10, 0xcd, 0x86, 0x48, 0xf0, 
+0x26, 0x28, 0xf4, 0xc8, 0x07, 0x02, 0x00, 0x00, 
+0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 
+0x05, 0x03, 0xeb, 0xa7, 0x00, 0x00, 0xff, 0xff, 
+0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x26, 0x6a, 0x24, 0xaa, 
+0x21, 0xa9, 0xed, 0x9f, 0x54, 0xb3, 0x4a, 0x41, 
+0xe6, 0x8d, 0xb1, 0x2d, 0x5b, 0x40, 0xaa, 0xf8, 
+0x24, 0x38, 0xe9, 0x31, 0x82, 0x1b, 0x5f, 0x68, 
+0x17, 0x67, 0xb1, 0x23, 0x2c, 0x36, 0x3f, 0x8d, 
+0xa1, 0x9f, 0x69, 0x01, 0x20, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0xb8, 0x77, 
+0xf4, 0x1a, 0x4e, 0xf5, 0x58, 0x63, 0x23, 0xb0, 
+0xfc, 0xc9, 0xff, 0x9b, 0xd9, 0x83, 0xfe, 0xee, 
+0xb6, 0xbc, 0x90, 0xce, 0x85, 0xfc, 0xe0, 0x49, 
+0x57, 0x44, 0xd5, 0xa7, 0x48, 0x7b, 0x07, 0x00, 
+0x00, 0x00, 0x6b, 0x48, 0x30, 0x45, 0x02, 0x21, 
+0x00, 0x8c, 0xf8, 0xed, 0x9a, 0x15, 0xc9, 0xc9, 
+0x99, 0xfa, 0x51, 0xd2, 0x71, 0xde, 0x59, 0xb0, 
+0x62, 0xa6, 0xb5, 0xb9, 0x9c, 0xd2, 0x05, 0x6f, 
+0x56, 0x8f, 0x4e, 0xf8, 0xac, 0xaf, 0x5d, 0x6f, 
+0xb7, 0x02, 0x20, 0x37, 0xf9, 0xf3, 0xa9, 0x0e, 
+0x1c, 0x59, 0x45, 0x3b, 0xc3, 0x55, 0xbd, 0x58, 
+0xa2, 0x99, 0x29, 0x33, 0x33, 0x51, 0x4a, 0x8e, 
+0x97, 0x9a, 0xef, 0x14, 0xda, 0x24, 0xbd, 0x30, 
+0x7a, 0x1f, 0x26, 0x01, 0x21, 0x03, 0x67, 0x93, 
+0x27, 0x65, 0x28, 0x9f, 0xa0, 0xea, 0x80, 0xe4, 
+0x64, 0x52, 0x25, 0xc0, 0x71, 0xe4, 0x1f, 0xbc, 
+0x1d, 0x76, 0xd3, 0x50, 0x03, 0x4f, 0xba, 0x5e, 
+0x45, 0x8e, 0xd2, 0x64, 0x46, 0x5e, 0xff, 0xff, 
+0xff, 0xff, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0x00, 0x00, 0x00, 0x00, 0x80, 0x13, 0xfa, 0x40, 
+0x04, 0x00, 0x00, 0x00, 0x23, 0x21, 0x03, 0x67, 
+0x93, 0x27, 0x65, 0x28, 0x9f, 0xa0, 0xea, 0x80, 
+0xe4, 0x64, 0x52, 0x25, 0xc0, 0x71, 0xe4, 0x1f, 
+0xbc, 0x1d, 0x76, 0xd3, 0x50, 0x03, 0x4f, 0xba, 
+0x5e, 0x45, 0x8e, 0xd2, 0x64, 0x46, 0x5e, 0xac, 
+0x96, 0x27, 0x00, 0x41, 0x04, 0x00, 0x00, 0x00, 
+0x23, 0x21, 0x03, 0x67, 0x93, 0x27, 0x65, 0x28, 
+0x9f, 0xa0, 0xea, 0x80, 0xe4, 0x64, 0x52, 0x25, 
+0xc0, 0x71, 0xe4, 0x1f, 0xbc, 0x1d, 0x76, 0xd3, 
+0x50, 0x03, 0x4f, 0xba, 0x5e, 0x45, 0x8e, 0xd2, 
+0x64, 0x46, 0x5e, 0xac, 0x11, 0x6e, 0x68, 0x02, 
+0x00, 0x00, 0x00, 0x00, 0x19, 0x76, 0xa9, 0x14, 
+0x5e, 0x56, 0xa1, 0x19, 0xd3, 0x5a, 0xc0, 0x66, 
+0xed, 0x56, 0xa1, 0x14, 0x69, 0xad, 0xbd, 0x46, 
+0x04, 0xc0, 0xa6, 0x02, 0x88, 0xac, 0x11, 0x6e, 
+0x68, 0x02, 0x00, 0x00, 0x00, 0x00, 0x19, 0x76, 
+0xa9, 0x14, 0xde, 0xd0, 0x6d, 0xd9, 0x39, 0xb8, 
+0x69, 0xb3, 0x7b, 0x4f, 0xdf, 0xc4, 0xe8, 0x57, 
+0xcc, 0x9c, 0xcd, 0x06, 0x7f, 0x43, 0x88, 0xac, 
+0x11, 0x6e, 0x68, 0x02, 0x00, 0x00, 0x00, 0x00, 
+0x19, 0x76, 0xa9, 0x14, 0xeb, 0x96, 0x0c, 0x27, 
+0xe6, 0x8d, 0xd6, 0x8a, 0x69, 0x4e, 0x15, 0x66, 
+0x2d, 0x7c, 0x5c, 0x32, 0x49, 0x06, 0x64, 0x61, 
+0x88, 0xac, 0x11, 0x6e, 0x68, 0x02, 0x00, 0x00, 
+0x00, 0x00, 0x19, 0x76, 0xa9, 0x14, 0x53, 0xff, 
+0xd7, 0x27, 0x46, 0x60, 0xa6, 0x86, 0xa7, 0x0e, 
+0x87, 0x10, 0x3a, 0x67, 0x19, 0xa1, 0x34, 0x36, 
+0x26, 0x8a, 0x88, 0xac, 0x11, 0x6e, 0x68, 0x02, 
+0x00, 0x00, 0x00, 0x00, 0x19, 0x76, 0xa9, 0x14, 
+0x2f, 0x3b, 0xee, 0xe4, 0x69, 0x98, 0x2b, 0xaf, 
+0x3f, 0xa3, 0x83, 0x7b, 0x89, 0xa7, 0x58, 0x0d, 
+0x54, 0x11, 0xaf, 0x59, 0x88, 0xac, 0x11, 0x6e, 
+0x68, 0x02, 0x00, 0x00, 0x00, 0x00, 0x19, 0x76, 
+0xa9, 0x14, 0x18, 0x84, 0x3d, 0xd1, 0xa0, 0xcb, 
+0xda, 0x3b, 0xd6, 0xf1, 0xb4, 0x88, 0x61, 0x7a, 
+0xcd, 0xb8, 0x79, 0x00, 0x59, 0x5d, 0x88, 0xac, 
+0x11, 0x6e, 0x68, 0x02, 0x00, 0x00, 0x00, 0x00, 
+0x19, 0x76, 0xa9, 0x14, 0xd7, 0x03, 0xb6, 0xcb, 
+0xc2, 0x8b, 0xf7, 0x45, 0xff, 0x4c, 0x0e, 0x3c, 
+0x78, 0x96, 0xd4, 0x13, 0x00, 0x27, 0xea, 0x31, 
+0x88, 0xac, 0x11, 0x6e, 0x68, 0x02, 0x00, 0x00, 
+0x00, 0x00, 0x19, 0x76, 0xa9, 0x14, 0xad, 0xd7, 
+0xc0, 0x7f, 0x4e, 0x87, 0x54, 0x9b, 0x17, 0xda, 
+0x34, 0x01, 0xed, 0x8a, 0x8c, 0x47, 0x96, 0x8c, 
+0xdf, 0x0a, 0x88, 0xac, 0x11, 0x6e, 0x68, 0x02, 
+0x00, 0x00, 0x00, 0x00, 0x19, 0x76, 0xa9, 0x14, 
+0x20, 0x57, 0x37, 0xcc, 0xa9, 0x5a, 0x84, 0x7a, 
+0x12, 0xea, 0xca, 0x8a, 0x28, 0x74, 0x96, 0x66, 
+0x3a, 0xd1, 0x48, 0x1b, 0x88, 0xac, 0x78, 0xe7, 
+0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x19, 0x76, 
+0xa9, 0x14, 0x0e, 0xb1, 0xb5, 0xf1, 0xbc, 0x1b, 
+0x4e, 0x0f, 0x06, 0x20, 0xae, 0x9c, 0xc5, 0x16, 
+0xb2, 0xdb, 0xb5, 0xf4, 0x91, 0x82, 0x88, 0xac, 
+0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 
+0x01, 0xea, 0x82, 0xca, 0x0d, 0xf1, 0xd1, 0x8c, 
+0x94, 0x19, 0x1b, 0x91, 0xbf, 0x77, 0x99, 0xab, 
+0xb8, 0xb2, 0xc6, 0xff, 0xb3, 0xbc, 0x41, 0x1b, 
+0x13, 0xb0, 0x06, 0x78, 0xde, 0x22, 0x42, 0x9b, 
+0x2f, 0x01, 0x00, 0x00, 0x00, 0x6a, 0x47, 0x30, 
+0x44, 0x02, 0x20, 0x4a, 0x36, 0x83, 0x5d, 0xf0, 
+0x37, 0xe4, 0xe7, 0x46, 0x26, 0x7f, 0x35, 0x1a, 
+0xf0, 0xc8, 0x62, 0xd2, 0xdc, 0x1b, 0x4c, 0xb1, 
+0xb8, 0x26, 0xb9, 0x57, 0xeb, 0xd2, 0xfb, 0xdd, 
+0xc3, 0x52, 0x20, 0x02, 0x20, 0x15, 0xf8, 0xc9, 
+0x17, 0x10, 0x6e, 0x4e, 0xc5, 0x6f, 0xb1, 0x6d, 
+0x82, 0x6d, 0x72, 0x38, 0xa3, 0x6e, 0x3f, 0x75, 
+0x71, 0xff, 0x1d, 0x3a, 0x3c, 0x7e, 0xfe, 0xaa, 
+0x1c, 0x7b, 0x40, 0xf5, 0xeb, 0x01, 0x21, 0x03, 
+0x38, 0x3a, 0x5a, 0x97, 0x84, 0xe8, 0x16, 0xf1, 
+0x0c, 0x63, 0xf0, 0x27, 0xff, 0x08, 0x48, 0x7a, 
+0xa9, 0x35, 0xba, 0x15, 0x85, 0x15, 0x76, 0xc0, 
+0x69, 0xc0, 0x48, 0xdb, 0xee, 0xd2, 0xe1, 0x54, 
+0xfe, 0xff, 0xff, 0xff, 0x02, 0xc0, 0x9e, 0xe6, 
+0x05, 0x00, 0x00, 0x00, 0x00, 0x19, 0x76, 0xa9, 
+0x14, 0x95, 0x00, 0xb4, 0x97, 0x6b, 0x85, 0x58, 
+0x22, 0xff, 0x57, 0xee, 0x19, 0x2f, 0x72, 0x33, 
+0x29, 0x4a, 0xdc, 0xb9, 0xa4, 0x88, 0xac, 0x70, 
+0x7b, 0xc3, 0x05, 0x00, 0x00, 0x00, 0x00, 0x19, 
+0x76, 0xa9, 0x14, 0x91, 0xd5, 0xd2, 0xe2, 0x4c, 
+0x15, 0x1a, 0x12, 0x76, 0xa9, 0xba, 0x13, 0x06, 
+0x9c, 0xab, 0x4f, 0x1e, 0xbb, 0x7c, 0xd3, 0x88, 
+0xac, 0xb7, 0xa7, 0x00, 0x00, 0x02, 0x00, 0x00, 
+0x00, 0x01, 0x89, 0x42, 0x02, 0x74, 0xed, 0x97, 
+0x88, 0x22, 0x00, 0x40, 0xb8, 0xf9, 0xd3, 0x2e, 
+0xd0, 0x03, 0x8c, 0xe8, 0x76, 0x95, 0x25, 0xc0, 
+0xc1, 0x4b, 0x13, 0x0a, 0x0c, 0x96, 0x8f, 0xd4, 
+0x78, 0x33, 0x00, 0x00, 0x00, 0x00, 0x6b, 0x48, 
+0x30, 0x45, 0x02, 0x21, 0x00, 0xb9, 0x2a, 0x1c, 
+0x1c, 0x02, 0x57, 0xca, 0xda, 0xc9, 0x96, 0xe1, 
+0x0e, 0xb8, 0x3f, 0x66, 0x5b, 0xbd, 0x3b, 0xe2, 
+0x3f, 0x05, 0x8b, 0x33, 0xd8, 0x8f, 0xaa, 0x0f, 
+0x8c, 0x67, 0xb7, 0xcb, 0xe5, 0x02, 0x20, 0x18, 
+0x5b, 0x2f, 0x92, 0xfa, 0x4c, 0x1d, 0x0e, 0x14, 
+0x2c, 0x5f, 0x8e, 0x80, 0xde, 0x74, 0xb7, 0x3c, 
+0x93, 0x41, 0xc4, 0x90, 0xef, 0xdf, 0xa0, 0x12, 
+0x5a, 0xe2, 0xd0, 0x45, 0x51, 0x8a, 0x98, 0x01, 
+0x21, 0x03, 0x55, 0x54, 0xfa, 0xcc, 0x48, 0x2d, 
+0xe6, 0xcf, 0x13, 0x4a, 0x60, 0x02, 0xac, 0xdc, 
+0x39, 0xd9, 0x5f, 0x62, 0x11, 0x23, 0xfd, 0x76, 
+0x3e, 0x78, 0x6b, 0xed, 0x10, 0xbd, 0x49, 0x6b, 
+0xee, 0x44, 0xfe, 0xff, 0xff, 0xff, 0x02, 0x98, 
+0x0e, 0xec, 0x88, 0xb1, 0x00, 0x00, 0x00, 0x19, 
+0x76, 0xa9, 0x14, 0xa0, 0x4b, 0x92, 0xaf, 0x90, 
+0x41, 0xbf, 0xb5, 0x65, 0x17, 0x88, 0xb8, 0x10, 
+0xee, 0x28, 0x94, 0xd3, 0x74, 0xaa, 0x01, 0x88, 
+0xac, 0x00, 0xe4, 0x0b, 0x54, 0x02, 0x00, 0x00, 
+0x00, 0x19, 0x76, 0xa9, 0x14, 0x18, 0x75, 0xf7, 
+0xbf, 0x6c, 0x81, 0x7a, 0x6d, 0xa2, 0x66, 0xdb, 
+0xee, 0xb1, 0x52, 0xea, 0x14, 0xef, 0xb3, 0x41, 
+0xb3, 0x88, 0xac, 0xea, 0xa7, 0x00, 0x00, 0x02, 
+0x00, 0x00, 0x00, 0x01, 0xc3, 0xbd, 0x57, 0xca, 
+0x6e, 0x50, 0x27, 0xba, 0x53, 0x45, 0x24, 0xfc, 
+0xb2, 0x26, 0xaa, 0x0e, 0xc9, 0x16, 0x75, 0x2a, 
+0xae, 0xf7, 0x65, 0x68, 0x36, 0x5f, 0x6e, 0x0a, 
+0x58, 0x0d, 0x68, 0x1d, 0x00, 0x00, 0x00, 0x00, 
+0x6b, 0x48, 0x30, 0x45, 0x02, 0x21, 0x00, 0xd5, 
+0x55, 0xd1, 0x9e, 0x8f, 0xd2, 0x9b, 0xa6, 0xfe, 
+0x8a, 0x16, 0xc4, 0xa6, 0xdb, 0x7e, 0xb5, 0x39, 
+0x8a, 0x2d, 0xf9, 0x06, 0x93, 0xde, 0xa1, 0x72, 
+0x96, 0xc7, 0x96, 0xcd, 0x11, 0x83, 0xd3, 0x02, 
+0x20, 0x35, 0x11, 0x99, 0x22, 0xf9, 0xae, 0x58, 
+0x0b, 0x96, 0xff, 0x07, 0x96, 0x96, 0x29, 0xbe, 
+0x89, 0x5f, 0x3f, 0xef, 0x8d, 0x34, 0xbd, 0xbd, 
+0x54, 0xda, 0xe3, 0xaf, 0x02, 0x8b, 0x56, 0x02, 
+0x8a, 0x01, 0x21, 0x03, 0xdc, 0x76, 0xc5, 0x00, 
+0x93, 0x56, 0xfb, 0x4f, 0xd9, 0xb3, 0xe0, 0xd9, 
+0x25, 0xfc, 0x10, 0x6f, 0x3c, 0x57, 0x2f, 0x42, 
+0x1e, 0xe7, 0x32, 0x72, 0x6c, 0xac, 0x04, 0x27, 
+0x79, 0xb4, 0xb0, 0x50, 0xfe, 0xff, 0xff, 0xff, 
+0x02, 0x00, 0xe4, 0x0b, 0x54, 0x02, 0x00, 0x00, 
+0x00, 0x19, 0x76, 0xa9, 0x14, 0x18, 0x75, 0xf7, 
+0xbf, 0x6c, 0x81, 0x7a, 0x6d, 0xa2, 0x66, 0xdb, 
+0xee, 0xb1, 0x52, 0xea, 0x14, 0xef, 0xb3, 0x41, 
+0xb3, 0x88, 0xac, 0x28, 0x41, 0xca, 0xa0, 0x1f, 
+0x0c, 0x00, 0x00, 0x19, 0x76, 0xa9, 0x14, 0x28, 
+0x47, 0x2b, 0x35, 0xcf, 0xb9, 0xac, 0x55, 0x19, 
+0xb3, 0xd2, 0xb7, 0x5f, 0xcf, 0xfb, 0xa8, 0x3f, 
+0x17, 0x65, 0xc5, 0x88, 0xac, 0xea, 0xa7, 0x00, 
+0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x47, 0xb2, 
+0xdc, 0x96, 0xda, 0xd0, 0x6a, 0xa5, 0x81, 0x65, 
+0x70, 0x68, 0x6a, 0x5a, 0x6e, 0x97, 0x3e, 0x26, 
+0x3f, 0x32, 0xc5, 0x2e, 0x44, 0xab, 0x03, 0xe6, 
+0xa7, 0xd9, 0x6a, 0xe8, 0x19, 0x83, 0x01, 0x00, 
+0x00, 0x00, 0x6b, 0x48, 0x30, 0x45, 0x02, 0x21, 
+0x00, 0xf9, 0xed, 0x53, 0x92, 0x84, 0x3f, 0x0a, 
+0xbe, 0x5a, 0xd2, 0xba, 0xe7, 0xfb, 0x06, 0x54, 
+0x20, 0x1d, 0x92, 0xfd, 0x66, 0xce, 0xfb, 0x44, 
+0x65, 0x4a, 0xdd, 0xb4, 0x92, 0x9a, 0x1d, 0x16, 
+0xcb, 0x02, 0x20, 0x75, 0x58, 0x97, 0x47, 0x71, 
+0x5f, 0xd4, 0x35, 0x77, 0x9e, 0x57, 0x4a, 0xc9, 
+0x48, 0xda, 0x59, 0xfd, 0x0f, 0x6b, 0xd6, 0x4d, 
+0x5e, 0xbd, 0x95, 0xc2, 0x00, 0xa8, 0x2c, 0x78, 
+0x0c, 0x6c, 0x03, 0x01, 0x21, 0x02, 0x5d, 0x32, 
+0xc5, 0xb6, 0x61, 0x6e, 0x8e, 0x6a, 0x3d, 0xd1, 
+0xd6, 0x96, 0xa2, 0x7b, 0x3c, 0xd2, 0xef, 0x8c, 
+0x61, 0x22, 0xd6, 0xe0, 0x1a, 0x4b, 0xca, 0x71, 
+0x01, 0x06, 0x4c, 0x3d, 0x9e, 0xcd, 0xfe, 0xff, 
+0xff, 0xff, 0x47, 0xb2, 0xdc, 0x96, 0xda, 0xd0, 
+0x6a, 0xa5, 0x81, 0x65, 0x70, 0x68, 0x6a, 0x5a, 
+0x6e, 0x97, 0x3e, 0x26, 0x3f, 0x32, 0xc5, 0x2e, 
+0x44, 0xab, 0x03, 0xe6, 0xa7, 0xd9, 0x6a, 0xe8, 
+0x19, 0x83, 0x00, 0x00, 0x00, 0x00, 0x6a, 0x47, 
+0x30, 0x44, 0x02, 0x20, 0x65, 0xcc, 0x5b, 0xdd, 
+0x4b, 0xf5, 0x88, 0x4f, 0x21, 0xf7, 0x75, 0xf3, 
+0xbf, 0x96, 0x0a, 0xbe, 0x6a, 0xc9, 0x8c, 0x20, 
+0xed, 0xb7, 0x42, 0x65, 0x85, 0xdb, 0x38, 0x5f, 
+0xaa, 0x47, 0x17, 0x87, 0x02, 0x20, 0x2c, 0x91, 
+0x74, 0x3d, 0x70, 0xff, 0x15, 0x4b, 0xbd, 0x8e, 
+0xf5, 0xf9, 0x18, 0x09, 0xd7, 0x88, 0x6d, 0x04, 
+0x83, 0x16, 0x33, 0x59, 0x2c, 0x39, 0xbd, 0xae, 
+0x81, 0xf5, 0xce, 0xae, 0xce, 0xf7, 0x01, 0x21, 
+0x02, 0x09, 0x61, 0x70, 0x38, 0xf5, 0xa6, 0x06, 
+0x1c, 0xcd, 0x58, 0xeb, 0xd9, 0x95, 0x7e, 0x20, 
+0xb3, 0x06, 0xe9, 0x0e, 0x22, 0xd9, 0xca, 0xe1, 
+0x34, 0x9b, 0xd1, 0xfe, 0x6a, 0x8c, 0x88, 0x40, 
+0x41, 0xfe, 0xff, 0xff, 0xff, 0x02, 0x00, 0xba, 
+0x1d, 0xd2, 0x05, 0x00, 0x00, 0x00, 0x20, 0x01, 
+0x04, 0x03, 0x90, 0xd0, 0x03, 0x01, 0x28, 0x01, 
+0x00, 0x14, 0x9d, 0x3d, 0x4c, 0xc1, 0x98, 0x6d, 
+0x81, 0xf9, 0x10, 0x9f, 0x2b, 0x09, 0x1b, 0x77, 
+0x32, 0xe7, 0xd9, 0xbc, 0xf6, 0x3b, 0xc2, 0xf6, 
+0xfa, 0x5e, 0x8c, 0x0e, 0x00, 0x00, 0x00, 0x19, 
+0x76, 0xa9, 0x14, 0x0e, 0xb1, 0xb5, 0xf1, 0xbc, 
+0x1b, 0x4e, 0x0f, 0x06, 0x20, 0xae, 0x9c, 0xc5, 
+0x16, 0xb2, 0xdb, 0xb5, 0xf4, 0x91, 0x82, 0x88, 
+0xac, 0xea, 0xa7, 0x00, 0x00, 0x02, 0x00, 0x00, 
+0x00, 0x01, 0x27, 0xd4, 0x61, 0xda, 0xd8, 0x86, 
+0xaf, 0x66, 0x6d, 0xab, 0xbc, 0x3b, 0x6d, 0xf8, 
+0x26, 0xb5, 0x06, 0xf6, 0x7d, 0xde, 0x29, 0x19, 
+0xf4, 0x5f, 0x13, 0x92, 0xb4, 0xb8, 0x62, 0x3f, 
+0x47, 0xb4, 0x00, 0x00, 0x00, 0x00, 0x01, 0xc3, 
+0xff, 0xff, 0xff, 0xff, 0x01, 0x00, 0xba, 0x1d, 
+0xd2, 0x05, 0x00, 0x00, 0x00, 0x19, 0x76, 0xa9, 
+0x14, 0x3d, 0xa1, 0x41, 0xa7, 0x1c, 0x92, 0xa2, 
+0x7f, 0x7c, 0x9d, 0xf2, 0x5c, 0x4e, 0x91, 0x8a, 
+0x79, 0x95, 0xdf, 0x14, 0xe8, 0x88, 0xac, 0x00, 
+0x00, 0x00, 0x00,      
+};
@@ -0,0 +1,72 @@
+// Copyright (c) 2018 The Abp Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <libdevcore/CommonData.h>
+#include <libevm/ExtVMFace.h>
+#include <libevm/VMFactory.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+
+/** Runs code without any state, calls out are not used by these loops */
+class BenchExtVM : public dev::eth::ExtVMFace
+{
+public:
+    BenchExtVM(const dev::eth::EnvInfo& envInfo, const dev::bytes& code)
+        : ExtVMFace(envInfo, dev::Address(), dev::Address(), dev::Address(), 0, 1, dev::bytesConstRef(), code, dev::sha3(code), 0) {}
+
+    boost::optional<dev::eth::owning_bytes_ref> call(dev::eth::CallParameters&) override { return boost::none; }
+};
+
+/**
+ * Interpret a loop that runs body 1024 times with the counter on top of the
+ * stack. body has to leave the stack as it found it.
+ *
+ *   PUSH2 0x0400 JUMPDEST <body> PUSH1 1 SWAP1 SUB DUP1 PUSH1 3 JUMPI STOP
+ */
+void RunOpcodeLoop(benchmark::State& state, const std::string& body)
+{
+    const dev::bytes code = dev::fromHex("610400" "5b" + body + "6001900380600357" "00");
+    const dev::eth::EnvInfo envInfo;
+    while (state.KeepRunning()) {
+        BenchExtVM ext(envInfo, code);
+        dev::u256 gas = 100000000;
+        std::unique_ptr<dev::eth::VMFace> vm = dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter);
+        vm->exec(gas, ext, dev::eth::OnOpFunc());
+    }
+}
+
+} // namespace
+
+// Only the loop itself: blocks ending in a jump back to their JUMPDEST.
+static void EVM_Loop(benchmark::State& state)
+{
+    RunOpcodeLoop(state, "");
+}
+
+// DUP1 DUP1 MUL DUP1 ADD POP
+static void EVM_Arithmetic(benchmark::State& state)
+{
+    RunOpcodeLoop(state, "808002800150");
+}
+
+// DUP1 DUP2 SWAP1 POP POP DUP1 PUSH32 ... POP POP
+static void EVM_Stack(benchmark::State& state)
+{
+    RunOpcodeLoop(state, "8081905050" "80" "7f" + std::string(64, 'f') + "5050");
+}
+
+// DUP1 PUSH1 0 MSTORE PUSH1 0 MLOAD POP, memory is priced per instruction
+static void EVM_Memory(benchmark::State& state)
+{
+    RunOpcodeLoop(state, "8060005260005150");
+}
+
+BENCHMARK(EVM_Loop, 2000);
+BENCHMARK(EVM_Arithmetic, 1000);
+BENCHMARK(EVM_Stack, 1000);
+BENCHMARK(EVM_Memory, 200);
@@ -0,0 +1,43 @@
+// Copyright (c) 2018 The Abp Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <libdevcore/SHA3.h>
+
+#include <vector>
+
+/* Number of bytes to hash per iteration */
+static const uint64_t BUFFER_SIZE = 1000*1000;
+
+static void Keccak256(benchmark::State& state)
+{
+    std::vector<uint8_t> in(BUFFER_SIZE, 0);
+    while (state.KeepRunning())
+        dev::sha3(in);
+}
+
+// One SHA3 opcode / secure-trie key sized input.
+static void Keccak256_32b(benchmark::State& state)
+{
+    dev::h256 h;
+    while (state.KeepRunning())
+        h = dev::sha3(h);
+}
+
+// Storage key hashing as done by a trie commit of 1024 dirty slots.
+static void Keccak256_Batch_32b_1024(benchmark::State& state)
+{
+    std::vector<dev::h256> keys(1024), hashes(1024);
+    std::vector<dev::bytesConstRef> refs(1024);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = dev::h256(i);
+        refs[i] = keys[i].ref();
+    }
+    while (state.KeepRunning())
+        dev::sha3Batch(refs.data(), hashes.data(), refs.size());
+}
+
+BENCHMARK(Keccak256, 230);
+BENCHMARK(Keccak256_32b, 2500 * 1000);
+BENCHMARK(Keccak256_Batch_32b_1024, 2500);
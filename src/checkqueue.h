@@ -96,7 +96,14 @@ private:
                         return fRet;
                     }
                     nIdle++;
-                    cond.wait(lock); // wait
+                    try {
+                        cond.wait(lock); // wait
+                    } catch (const boost::thread_interrupted&) {
+                        // leave the counts right for the workers started after this one
+                        nIdle--;
+                        nTotal--;
+                        throw;
+                    }
                     nIdle--;
                 }
                 // Decide how many work units to process now.
@@ -243,6 +243,13 @@ public:
      */
     bool HaveCoinInCache(const COutPoint &outpoint) const;
 
+    /**
+     * Add a coin that was read from the backing view elsewhere (e.g. by a
+     * prefetch thread) to the cache, as if it had been fetched on a miss.
+     * Has no effect if the outpoint is cached already.
+     */
+    void CacheFetchedCoin(const COutPoint &outpoint, Coin&& coin);
+
     /**
      * Return a reference to Coin in the cache, or a pruned one if not found. This is
      * more efficient than GetCoin.
@@ -0,0 +1,257 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinstats.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <init.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <ui_interface.h>
+#include <undo.h>
+#include <util.h>
+#include <validation.h>
+
+static const char DB_COINSTATS = 's';
+static const char DB_BEST_BLOCK = 'B';
+static const char DB_MUHASH = 'M';
+
+//! Blocks between writes of the index while it catches up
+static const int COINSTATS_SYNC_FLUSH_INTERVAL = 10000;
+
+std::unique_ptr<CCoinStatsIndex> pcoinstatsindex;
+
+namespace {
+
+/** The bytes a coin contributes to the rolling hash: its outpoint, height and flags, and output. */
+CDataStream CoinSerialize(const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << outpoint;
+    ss << (uint32_t)((coin.nHeight << 2) + (coin.fCoinStake ? 2 : 0) + (coin.fCoinBase ? 1 : 0));
+    ss << coin.out;
+    return ss;
+}
+
+/** Whether the undo data has the spent coins of every input of the block. */
+bool CheckUndo(const CBlock& block, const CBlockUndo& blockundo)
+{
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: block and undo data inconsistent", __func__);
+    }
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        if (blockundo.vtxundo[i - 1].vprevout.size() != block.vtx[i]->vin.size()) {
+            return error("%s: transaction and undo data inconsistent", __func__);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void MuHashInsertCoin(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss = CoinSerialize(outpoint, coin);
+    muhash.Insert((const unsigned char*)ss.data(), ss.size());
+}
+
+void MuHashRemoveCoin(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss = CoinSerialize(outpoint, coin);
+    muhash.Remove((const unsigned char*)ss.data(), ss.size());
+}
+
+uint64_t GetBogoSize(const Coin& coin)
+{
+    return 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
+           2 /* scriptPubKey len */ + coin.out.scriptPubKey.size() /* scriptPubKey */;
+}
+
+CCoinStatsIndex::CCoinStatsIndex(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "coinstats", nCacheSize, fMemory, fWipe)
+{
+    if (db.Read(DB_BEST_BLOCK, hashBestBlock) && !db.Read(DB_MUHASH, muhash)) {
+        hashBestBlock.SetNull();
+    }
+    if (!hashBestBlock.IsNull() && !db.Read(std::make_pair(DB_COINSTATS, hashBestBlock), best)) {
+        hashBestBlock.SetNull();
+    }
+}
+
+bool CCoinStatsIndex::WriteBest()
+{
+    CDBBatch batch(db);
+    batch.Write(DB_BEST_BLOCK, hashBestBlock);
+    batch.Write(DB_MUHASH, muhash);
+    return db.WriteBatch(batch, true);
+}
+
+bool CCoinStatsIndex::Reset(const uint256& hashGenesis)
+{
+    // The outputs of the genesis block are not part of the UTXO set
+    hashBestBlock = hashGenesis;
+    best = CCoinStatsEntry();
+    muhash = MuHash3072();
+    muhash.Finalize(best.hashMuHash.begin());
+    return db.Write(std::make_pair(DB_COINSTATS, hashBestBlock), best) && WriteBest();
+}
+
+bool CCoinStatsIndex::ConnectBlock(const CBlock& block, const CBlockIndex* pindex, const CBlockUndo& blockundo)
+{
+    if (hashBestBlock.IsNull() || !pindex->pprev || pindex->pprev->GetBlockHash() != hashBestBlock) {
+        // Not a block on top of the index, such as one re-checked by VerifyDB
+        return true;
+    }
+    if (!CheckUndo(block, blockundo)) {
+        return false;
+    }
+
+    CCoinStatsEntry stats = best;
+    stats.nHeight = pindex->nHeight;
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = *block.vtx[i];
+        const uint256& hash = tx.GetHash();
+        for (size_t o = 0; o < tx.vout.size(); ++o) {
+            if (tx.vout[o].scriptPubKey.IsUnspendable()) continue;
+            Coin coin(tx.vout[o], pindex->nHeight, tx.IsCoinBase(), tx.IsCoinStake());
+            MuHashInsertCoin(muhash, COutPoint(hash, o), coin);
+            stats.nTransactionOutputs++;
+            stats.nTotalAmount += coin.out.nValue;
+            stats.nBogoSize += GetBogoSize(coin);
+        }
+        if (i == 0) continue;
+
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        for (size_t j = 0; j < tx.vin.size(); ++j) {
+            const Coin& coin = txundo.vprevout[j];
+            MuHashRemoveCoin(muhash, tx.vin[j].prevout, coin);
+            stats.nTransactionOutputs--;
+            stats.nTotalAmount -= coin.out.nValue;
+            stats.nBogoSize -= GetBogoSize(coin);
+        }
+    }
+    muhash.Finalize(stats.hashMuHash.begin());
+
+    if (!db.Write(std::make_pair(DB_COINSTATS, pindex->GetBlockHash()), stats)) {
+        return error("%s: failed to write the statistics of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    hashBestBlock = pindex->GetBlockHash();
+    best = stats;
+    return true;
+}
+
+bool CCoinStatsIndex::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, const CBlockUndo& blockundo)
+{
+    if (pindex->GetBlockHash() != hashBestBlock) {
+        return true;
+    }
+    if (!CheckUndo(block, blockundo)) {
+        return false;
+    }
+
+    // The statistics of the previous block were recorded when it was
+    // connected, only the rolling hash has to be taken back
+    CCoinStatsEntry stats;
+    if (!db.Read(std::make_pair(DB_COINSTATS, pindex->pprev->GetBlockHash()), stats)) {
+        return error("%s: no statistics for block %s", __func__, pindex->pprev->GetBlockHash().ToString());
+    }
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = *block.vtx[i];
+        const uint256& hash = tx.GetHash();
+        for (size_t o = 0; o < tx.vout.size(); ++o) {
+            if (tx.vout[o].scriptPubKey.IsUnspendable()) continue;
+            MuHashRemoveCoin(muhash, COutPoint(hash, o), Coin(tx.vout[o], pindex->nHeight, tx.IsCoinBase(), tx.IsCoinStake()));
+        }
+        if (i == 0) continue;
+
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        for (size_t j = 0; j < tx.vin.size(); ++j) {
+            MuHashInsertCoin(muhash, tx.vin[j].prevout, txundo.vprevout[j]);
+        }
+    }
+
+    hashBestBlock = pindex->pprev->GetBlockHash();
+    best = stats;
+    return true;
+}
+
+bool CCoinStatsIndex::Flush()
+{
+    if (hashBestBlock.IsNull()) return true;
+    return WriteBest();
+}
+
+bool CCoinStatsIndex::LookupStats(const uint256& hashBlock, CCoinStatsEntry& stats) const
+{
+    return db.Read(std::make_pair(DB_COINSTATS, hashBlock), stats);
+}
+
+bool SyncCoinStatsIndex(const CChainParams& chainparams)
+{
+    LOCK(cs_main);
+    CCoinStatsIndex& index = *pcoinstatsindex;
+    const uint256& hashGenesis = chainparams.GetConsensus().hashGenesisBlock;
+
+    const CBlockIndex* pindex = nullptr;
+    BlockMap::const_iterator it = mapBlockIndex.find(index.GetBestBlock());
+    if (it != mapBlockIndex.end()) {
+        pindex = it->second;
+    } else {
+        if (!index.GetBestBlock().IsNull()) {
+            LogPrintf("%s: best block of the coin statistics index is unknown, rebuilding it\n", __func__);
+        }
+        if (!index.Reset(hashGenesis)) {
+            return error("%s: failed to reset the coin statistics index", __func__);
+        }
+        // The genesis block is connected later when reindexing
+        pindex = chainActive.Genesis();
+    }
+    if (!chainActive.Tip()) {
+        return true;
+    }
+
+    // Take back the blocks that were disconnected while the index was not
+    // running, or whose connection it missed saving
+    while (!chainActive.Contains(pindex)) {
+        CBlock block;
+        CBlockUndo blockundo;
+        if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()) || !UndoReadFromDisk(blockundo, pindex) ||
+            !index.DisconnectBlock(block, pindex, blockundo)) {
+            LogPrintf("%s: unable to rewind the coin statistics index from block %s, rebuilding it\n", __func__, pindex->GetBlockHash().ToString());
+            if (!index.Reset(hashGenesis)) {
+                return error("%s: failed to reset the coin statistics index", __func__);
+            }
+            pindex = chainActive.Genesis();
+            break;
+        }
+        pindex = pindex->pprev;
+    }
+
+    if (pindex != chainActive.Tip()) {
+        uiInterface.InitMessage(_("Building coin statistics index..."));
+        LogPrintf("Building the coin statistics index from height %d to %d\n", pindex->nHeight, chainActive.Height());
+    }
+    while (pindex != chainActive.Tip()) {
+        if (ShutdownRequested()) {
+            break;
+        }
+        pindex = chainActive.Next(pindex);
+        CBlock block;
+        CBlockUndo blockundo;
+        if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()) || !UndoReadFromDisk(blockundo, pindex)) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!index.ConnectBlock(block, pindex, blockundo)) {
+            return false;
+        }
+        if (pindex->nHeight % COINSTATS_SYNC_FLUSH_INTERVAL == 0) {
+            LogPrintf("Coin statistics index is at height %d\n", pindex->nHeight);
+            if (!index.Flush()) {
+                return error("%s: failed to write the coin statistics index", __func__);
+            }
+        }
+    }
+    return index.Flush();
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_COINSTATS_H
+#define BITCOIN_COINSTATS_H
+
+#include <amount.h>
+#include <crypto/muhash.h>
+#include <dbwrapper.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <memory>
+
+class CBlock;
+class CBlockIndex;
+class CBlockUndo;
+class CChainParams;
+class COutPoint;
+class Coin;
+
+//! -coinstatsindex default
+static const bool DEFAULT_COINSTATSINDEX = false;
+//! Memory allocated to the coin statistics index cache (MiB)
+static const int64_t nCoinStatsIndexCache = 8;
+
+/** Add a coin to the rolling hash of the UTXO set. */
+void MuHashInsertCoin(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
+/** Remove a coin from the rolling hash of the UTXO set. */
+void MuHashRemoveCoin(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
+/** The contribution of a coin to the bogosize of the UTXO set. */
+uint64_t GetBogoSize(const Coin& coin);
+
+/** Statistics of the UTXO set as of a block. */
+struct CCoinStatsEntry
+{
+    int nHeight;
+    uint64_t nTransactionOutputs;
+    uint64_t nBogoSize;
+    CAmount nTotalAmount;
+    uint256 hashMuHash;
+
+    CCoinStatsEntry() : nHeight(0), nTransactionOutputs(0), nBogoSize(0), nTotalAmount(0) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(VARINT(nHeight));
+        READWRITE(VARINT(nTransactionOutputs));
+        READWRITE(VARINT(nBogoSize));
+        READWRITE(nTotalAmount);
+        READWRITE(hashMuHash);
+    }
+};
+
+/**
+ * Index of the UTXO set statistics after every block (coinstats/), kept up to
+ * date from the spent coins in the undo data as blocks are connected and
+ * disconnected, so that they need no pass over the UTXO set.
+ *
+ * The index follows its best block: it only applies a block connected on top
+ * of it or disconnecting it, and ignores blocks that are checked off the
+ * active chain, such as by VerifyDB. Its best block and rolling hash are
+ * written when the chainstate is flushed, so that after a crash it is never
+ * ahead of the chainstate, and SyncCoinStatsIndex catches up from there.
+ * Entries are kept by block hash and stay valid across reorganizations.
+ *
+ * All methods require cs_main.
+ */
+class CCoinStatsIndex
+{
+private:
+    CDBWrapper db;
+    uint256 hashBestBlock;
+    CCoinStatsEntry best;
+    MuHash3072 muhash;
+
+    bool WriteBest();
+
+public:
+    explicit CCoinStatsIndex(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+
+    CCoinStatsIndex(const CCoinStatsIndex&) = delete;
+    CCoinStatsIndex& operator=(const CCoinStatsIndex&) = delete;
+
+    /** The block the running statistics are at, null if the index is empty. */
+    const uint256& GetBestBlock() const { return hashBestBlock; }
+
+    /** Start over with the empty UTXO set of the genesis block. */
+    bool Reset(const uint256& hashGenesis);
+
+    /** Apply a block connected on top of the best block, with the coins it spent. */
+    bool ConnectBlock(const CBlock& block, const CBlockIndex* pindex, const CBlockUndo& blockundo);
+    /** Revert the best block, given the coins it spent. */
+    bool DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, const CBlockUndo& blockundo);
+
+    /** Write the best block and the rolling hash, to be called once the chainstate is flushed. */
+    bool Flush();
+
+    /** Statistics as of a block, false if the index has none for it. */
+    bool LookupStats(const uint256& hashBlock, CCoinStatsEntry& stats) const;
+};
+
+/** Bring the index to the active chain tip, reading the blocks and undo data in between. */
+bool SyncCoinStatsIndex(const CChainParams& chainparams);
+
+/** The UTXO set statistics index, null unless -coinstatsindex */
+extern std::unique_ptr<CCoinStatsIndex> pcoinstatsindex;
+
+#endif // BITCOIN_COINSTATS_H
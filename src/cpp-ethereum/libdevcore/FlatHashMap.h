@@ -0,0 +1,218 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file FlatHashMap.h
+ * Open addressing hash map for the state caches.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dev
+{
+
+/**
+ * Hash map keeping its entries in one array, probed linearly and erased by
+ * shifting the following entries back, so that there are no tombstones.
+ *
+ * Unlike std::unordered_map, inserting may move every entry: pointers,
+ * references and iterators are only valid until the next insertion or erase.
+ * Iteration order is unspecified.
+ */
+template <class K, class V, class H = std::hash<K>>
+class FlatHashMap
+{
+public:
+	using key_type = K;
+	using mapped_type = V;
+	using value_type = std::pair<K, V>;
+
+	template <bool IsConst>
+	class Iterator
+	{
+		using Map = typename std::conditional<IsConst, FlatHashMap const, FlatHashMap>::type;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename std::conditional<IsConst, FlatHashMap::value_type const, FlatHashMap::value_type>::type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = value_type*;
+		using reference = value_type&;
+
+		Iterator(Map* _map, size_t _i): m_map(_map), m_i(_i) { skipEmpty(); }
+		template <bool C = IsConst, class = typename std::enable_if<C>::type>
+		Iterator(Iterator<false> const& _it): m_map(_it.m_map), m_i(_it.m_i) {}
+
+		reference operator*() const { return m_map->m_slots[m_i]; }
+		pointer operator->() const { return &m_map->m_slots[m_i]; }
+		Iterator& operator++() { ++m_i; skipEmpty(); return *this; }
+		Iterator operator++(int) { Iterator ret = *this; ++*this; return ret; }
+
+		bool operator==(Iterator const& _it) const { return m_i == _it.m_i; }
+		bool operator!=(Iterator const& _it) const { return m_i != _it.m_i; }
+
+	private:
+		void skipEmpty() { while (m_i < m_map->m_used.size() && !m_map->m_used[m_i]) ++m_i; }
+
+		friend class FlatHashMap;
+		friend class Iterator<true>;
+
+		Map* m_map;
+		size_t m_i;
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, m_used.size()); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, m_used.size()); }
+
+	size_t size() const { return m_size; }
+	bool empty() const { return !m_size; }
+
+	iterator find(K const& _k) { size_t i = lookup(_k); return iterator(this, i); }
+	const_iterator find(K const& _k) const { size_t i = lookup(_k); return const_iterator(this, i); }
+	size_t count(K const& _k) const { return lookup(_k) != m_used.size(); }
+
+	/// Inserts @a _v at @a _k unless @a _k is already present.
+	/// @returns the entry at @a _k and whether it was inserted.
+	std::pair<iterator, bool> emplace(K const& _k, V _v)
+	{
+		grow();
+		size_t i = probe(_k);
+		if (m_used[i])
+			return std::make_pair(iterator(this, i), false);
+		m_slots[i].first = _k;
+		m_slots[i].second = std::move(_v);
+		m_used[i] = 1;
+		++m_size;
+		return std::make_pair(iterator(this, i), true);
+	}
+
+	V& operator[](K const& _k)
+	{
+		size_t i = lookup(_k);
+		if (i == m_used.size())
+			i = emplace(_k, V()).first.m_i;
+		return m_slots[i].second;
+	}
+
+	size_t erase(K const& _k)
+	{
+		size_t i = lookup(_k);
+		if (i == m_used.size())
+			return 0;
+		eraseAt(i);
+		return 1;
+	}
+	void erase(const_iterator _it) { eraseAt(_it.m_i); }
+
+	/// Removes all entries, keeping the table for the next ones.
+	void clear()
+	{
+		if (!m_size)
+			return;
+		for (size_t i = 0; i < m_used.size(); ++i)
+			if (m_used[i])
+			{
+				m_slots[i] = value_type();
+				m_used[i] = 0;
+			}
+		m_size = 0;
+	}
+
+private:
+	size_t home(K const& _k) const
+	{
+		// Spread the key's hash over the top bits, std::hash of FixedHash and
+		// u256 is not well mixed in its low bits
+		return size_t((uint64_t(H()(_k)) * 0x9e3779b97f4a7c15ULL) >> m_shift);
+	}
+
+	/// @returns the slot of @a _k or of the empty slot where it would go.
+	size_t probe(K const& _k) const
+	{
+		size_t const mask = m_used.size() - 1;
+		size_t i = home(_k);
+		while (m_used[i] && !(m_slots[i].first == _k))
+			i = (i + 1) & mask;
+		return i;
+	}
+
+	/// @returns the slot of @a _k or the end.
+	size_t lookup(K const& _k) const
+	{
+		if (!m_size)
+			return m_used.size();
+		size_t i = probe(_k);
+		return m_used[i] ? i : m_used.size();
+	}
+
+	void eraseAt(size_t _i)
+	{
+		size_t const mask = m_used.size() - 1;
+		size_t hole = _i;
+		for (size_t j = (_i + 1) & mask; m_used[j]; j = (j + 1) & mask)
+			// An entry may fill the hole if the hole lies between its home and
+			// where it is now
+			if (((j - home(m_slots[j].first)) & mask) >= ((j - hole) & mask))
+			{
+				m_slots[hole] = std::move(m_slots[j]);
+				hole = j;
+			}
+		m_slots[hole] = value_type();
+		m_used[hole] = 0;
+		--m_size;
+	}
+
+	/// Makes room for one more entry, keeping the table at most 3/4 full.
+	void grow()
+	{
+		if ((m_size + 1) * 4 <= m_used.size() * 3)
+			return;
+		std::vector<value_type> slots(m_used.empty() ? c_minCapacity : m_used.size() * 2);
+		std::vector<uint8_t> used(slots.size());
+		slots.swap(m_slots);
+		used.swap(m_used);
+		m_shift = 64;
+		for (size_t n = m_used.size(); n > 1; n >>= 1)
+			--m_shift;
+		for (size_t i = 0; i < used.size(); ++i)
+			if (used[i])
+			{
+				size_t j = probe(slots[i].first);
+				m_slots[j] = std::move(slots[i]);
+				m_used[j] = 1;
+			}
+	}
+
+	static size_t const c_minCapacity = 8;
+
+	std::vector<value_type> m_slots;
+	std::vector<uint8_t> m_used;
+	size_t m_size = 0;
+	unsigned m_shift = 64;
+};
+
+}
@@ -29,6 +29,14 @@
 using namespace std;
 using namespace dev;
 
+#if defined(ENABLE_AVX2) && (defined(__x86_64__) || defined(__amd64__))
+namespace keccak_avx2
+{
+void Keccak256_4way(unsigned char* out, const unsigned char* const* in, const size_t* len);
+}
+#define KECCAK_HAVE_4WAY 1
+#endif
+
 namespace dev
 {
 
@@ -63,16 +71,6 @@ decsha3(512)
 /******** The Keccak-f[1600] permutation ********/
 
 /*** Constants. ***/
-static const uint8_t rho[24] = \
-  { 1,  3,   6, 10, 15, 21,
-	28, 36, 45, 55,  2, 14,
-	27, 41, 56,  8, 25, 43,
-	62, 18, 39, 61, 20, 44};
-static const uint8_t pi[24] = \
-  {10,  7, 11, 17, 18, 3,
-	5, 16,  8, 21, 24, 4,
-   15, 23, 19, 13, 12, 2,
-   20, 14, 22,  9, 6,  1};
 static const uint64_t RC[24] = \
   {1ULL, 0x8082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
    0x808bULL, 0x80000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
@@ -83,48 +81,108 @@ static const uint64_t RC[24] = \
 
 /*** Helper macros to unroll the permutation. ***/
 #define rol(x, s) (((x) << s) | ((x) >> (64 - s)))
-#define REPEAT6(e) e e e e e e
-#define REPEAT24(e) REPEAT6(e e e e)
-#define REPEAT5(e) e e e e e
-#define FOR5(v, s, e) \
-  v = 0;            \
-  REPEAT5(e; v += s;)
 
 /*** Keccak-f[1600] ***/
-static inline void keccakf(void* state) {
-  uint64_t* a = (uint64_t*)state;
-  uint64_t b[5] = {0};
-  uint64_t t = 0;
-  uint8_t x, y;
-
-  for (int i = 0; i < 24; i++) {
-	// Theta
-	FOR5(x, 1,
-		 b[x] = 0;
-		 FOR5(y, 5,
-			  b[x] ^= a[x + y]; ))
-	FOR5(x, 1,
-		 FOR5(y, 5,
-			  a[y + x] ^= b[(x + 4) % 5] ^ rol(b[(x + 1) % 5], 1); ))
-	// Rho and pi
-	t = a[1];
-	x = 0;
-	REPEAT24(b[0] = a[pi[x]];
-			 a[pi[x]] = rol(t, rho[x]);
-			 t = b[0];
-			 x++; )
-	// Chi
-	FOR5(y,
-	   5,
-	   FOR5(x, 1,
-			b[x] = a[y + x];)
-	   FOR5(x, 1,
-			a[y + x] = b[x] ^ ((~b[(x + 1) % 5]) & b[(x + 2) % 5]); ))
-	// Iota
-	a[0] ^= RC[i];
+
+/**
+ * Fully unrolled 64-bit implementation, two rounds per loop iteration with the
+ * state held in 25 named lanes (after the Keccak team's opt64 reference).
+ * Lanes 1, 2, 8, 12, 17 and 20 are kept complemented while the permutation
+ * runs ("lane complementing"), which turns most of the NOT operations of chi
+ * into plain AND/OR; the complement is applied on entry and undone on exit so
+ * the sponge sees the standard state.
+ */
+#define KECCAK_ROUND(A, E, rc) \
+	Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+	Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+	Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+	Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+	Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+	Da = Cu ^ rol(Ce, 1); \
+	De = Ca ^ rol(Ci, 1); \
+	Di = Ce ^ rol(Co, 1); \
+	Do = Ci ^ rol(Cu, 1); \
+	Du = Co ^ rol(Ca, 1); \
+	\
+	Ba = A##ba ^ Da; \
+	Be = rol(A##ge ^ De, 44); \
+	Bi = rol(A##ki ^ Di, 43); \
+	Bo = rol(A##mo ^ Do, 21); \
+	Bu = rol(A##su ^ Du, 14); \
+	E##ba = Ba ^ (Be | Bi) ^ (rc); \
+	E##be = Be ^ ((~Bi) | Bo); \
+	E##bi = Bi ^ (Bo & Bu); \
+	E##bo = Bo ^ (Bu | Ba); \
+	E##bu = Bu ^ (Ba & Be); \
+	\
+	Ba = rol(A##bo ^ Do, 28); \
+	Be = rol(A##gu ^ Du, 20); \
+	Bi = rol(A##ka ^ Da, 3); \
+	Bo = rol(A##me ^ De, 45); \
+	Bu = rol(A##si ^ Di, 61); \
+	E##ga = Ba ^ (Be | Bi); \
+	E##ge = Be ^ (Bi & Bo); \
+	E##gi = Bi ^ (Bo | (~Bu)); \
+	E##go = Bo ^ (Bu | Ba); \
+	E##gu = Bu ^ (Ba & Be); \
+	\
+	Ba = rol(A##be ^ De, 1); \
+	Be = rol(A##gi ^ Di, 6); \
+	Bi = rol(A##ko ^ Do, 25); \
+	Bo = rol(A##mu ^ Du, 8); \
+	Bu = rol(A##sa ^ Da, 18); \
+	E##ka = Ba ^ (Be | Bi); \
+	E##ke = Be ^ (Bi & Bo); \
+	E##ki = Bi ^ ((~Bo) & Bu); \
+	E##ko = (~Bo) ^ (Bu | Ba); \
+	E##ku = Bu ^ (Ba & Be); \
+	\
+	Ba = rol(A##bu ^ Du, 27); \
+	Be = rol(A##ga ^ Da, 36); \
+	Bi = rol(A##ke ^ De, 10); \
+	Bo = rol(A##mi ^ Di, 15); \
+	Bu = rol(A##so ^ Do, 56); \
+	E##ma = Ba ^ (Be & Bi); \
+	E##me = Be ^ (Bi | Bo); \
+	E##mi = Bi ^ ((~Bo) | Bu); \
+	E##mo = (~Bo) ^ (Bu & Ba); \
+	E##mu = Bu ^ (Ba | Be); \
+	\
+	Ba = rol(A##bi ^ Di, 62); \
+	Be = rol(A##go ^ Do, 55); \
+	Bi = rol(A##ku ^ Du, 39); \
+	Bo = rol(A##ma ^ Da, 41); \
+	Bu = rol(A##se ^ De, 2); \
+	E##sa = Ba ^ ((~Be) & Bi); \
+	E##se = (~Be) ^ (Bi | Bo); \
+	E##si = Bi ^ (Bo & Bu); \
+	E##so = Bo ^ (Bu | Ba); \
+	E##su = Bu ^ (Ba & Be);
+
+static inline void keccakf(uint64_t* a) {
+  uint64_t Aba = a[0], Abe = ~a[1], Abi = ~a[2], Abo = a[3], Abu = a[4];
+  uint64_t Aga = a[5], Age = a[6], Agi = a[7], Ago = ~a[8], Agu = a[9];
+  uint64_t Aka = a[10], Ake = a[11], Aki = ~a[12], Ako = a[13], Aku = a[14];
+  uint64_t Ama = a[15], Ame = a[16], Ami = ~a[17], Amo = a[18], Amu = a[19];
+  uint64_t Asa = ~a[20], Ase = a[21], Asi = a[22], Aso = a[23], Asu = a[24];
+  uint64_t Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+  uint64_t Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+  uint64_t Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+
+  for (int i = 0; i < 24; i += 2) {
+	KECCAK_ROUND(A, E, RC[i])
+	KECCAK_ROUND(E, A, RC[i + 1])
   }
+
+  a[0] = Aba; a[1] = ~Abe; a[2] = ~Abi; a[3] = Abo; a[4] = Abu;
+  a[5] = Aga; a[6] = Age; a[7] = Agi; a[8] = ~Ago; a[9] = Agu;
+  a[10] = Aka; a[11] = Ake; a[12] = ~Aki; a[13] = Ako; a[14] = Aku;
+  a[15] = Ama; a[16] = Ame; a[17] = ~Ami; a[18] = Amo; a[19] = Amu;
+  a[20] = ~Asa; a[21] = Ase; a[22] = Asi; a[23] = Aso; a[24] = Asu;
 }
 
+#undef KECCAK_ROUND
+
 /******** The FIPS202-defined functions. ********/
 
 /*** Some helper macros. ***/
@@ -132,12 +190,6 @@ static inline void keccakf(void* state) {
 #define _(S) do { S } while (0)
 #define FOR(i, ST, L, S) \
   _(for (size_t i = 0; i < L; i += ST) { S; })
-#define mkapply_ds(NAME, S)                                          \
-  static inline void NAME(uint8_t* dst,                              \
-						  const uint8_t* src,                        \
-						  size_t len) {                              \
-	FOR(i, 1, len, S);                                               \
-  }
 #define mkapply_sd(NAME, S)                                          \
   static inline void NAME(const uint8_t* src,                        \
 						  uint8_t* dst,                              \
@@ -145,10 +197,23 @@ static inline void keccakf(void* state) {
 	FOR(i, 1, len, S);                                               \
   }
 
-mkapply_ds(xorin, dst[i] ^= src[i])  // xorin
 mkapply_sd(setout, dst[i] = src[i])  // setout
 
-#define P keccakf
+// Absorb a lane at a time; the state is little-endian lanes, as is the input.
+static inline void xorin(uint8_t* dst, const uint8_t* src, size_t len) {
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+	uint64_t d, v;
+	memcpy(&d, dst + i, 8);
+	memcpy(&v, src + i, 8);
+	d ^= v;
+	memcpy(dst + i, &d, 8);
+  }
+  for (; i < len; ++i)
+	dst[i] ^= src[i];
+}
+
+#define P(a) keccakf((uint64_t*)(a))
 #define Plen 200
 
 // Fold P*F over the full blocks of an input.
@@ -167,7 +232,8 @@ static inline int hash(uint8_t* out, size_t outlen,
   if ((out == NULL) || ((in == NULL) && inlen != 0) || (rate >= Plen)) {
 	return -1;
   }
-  uint8_t a[Plen] = {0};
+  uint64_t lanes[Plen / 8] = {0};
+  uint8_t* a = (uint8_t*)lanes;
   // Absorb input.
   foldP(in, inlen, xorin);
   // Xor in the DS and pad frame.
@@ -180,7 +246,7 @@ static inline int hash(uint8_t* out, size_t outlen,
   // Squeeze output.
   foldP(out, outlen, setout);
   setout(a, out, outlen);
-  memset(a, 0, 200);
+  memset(lanes, 0, Plen);
   return 0;
 }
 
@@ -211,6 +277,74 @@ defsha3(512)
 
 }
 
+namespace
+{
+
+/// Largest input that fits in one Keccak-256 sponge block (rate 136, one pad byte).
+static const size_t c_singleBlockInput = 135;
+
+#ifdef KECCAK_HAVE_4WAY
+static bool have4Way()
+{
+	static const bool s_avx2 = __builtin_cpu_supports("avx2");
+	return s_avx2;
+}
+#endif
+
+}
+
+std::string sha3Implementation()
+{
+#ifdef KECCAK_HAVE_4WAY
+	if (have4Way())
+		return "opt64-lcu,avx2(4way)";
+#endif
+	return "opt64-lcu";
+}
+
+void sha3Batch(bytesConstRef const* _inputs, h256* o_outputs, size_t _count)
+{
+	size_t i = 0;
+#ifdef KECCAK_HAVE_4WAY
+	if (have4Way())
+	{
+		// Gather runs of four single-block inputs; anything longer is hashed
+		// on its own as it is met.
+		size_t pending[4];
+		size_t n = 0;
+		for (; i < _count; ++i)
+		{
+			if (_inputs[i].size() > c_singleBlockInput)
+			{
+				sha3(_inputs[i], o_outputs[i].ref());
+				continue;
+			}
+			pending[n++] = i;
+			if (n == 4)
+			{
+				unsigned char const* in[4];
+				size_t len[4];
+				unsigned char out[4 * 32];
+				for (size_t j = 0; j < 4; ++j)
+				{
+					in[j] = _inputs[pending[j]].data();
+					len[j] = _inputs[pending[j]].size();
+				}
+				keccak_avx2::Keccak256_4way(out, in, len);
+				for (size_t j = 0; j < 4; ++j)
+					memcpy(o_outputs[pending[j]].data(), out + 32 * j, 32);
+				n = 0;
+			}
+		}
+		for (size_t j = 0; j < n; ++j)
+			sha3(_inputs[pending[j]], o_outputs[pending[j]].ref());
+		return;
+	}
+#endif
+	for (; i < _count; ++i)
+		sha3(_inputs[i], o_outputs[i].ref());
+}
+
 bool sha3(bytesConstRef _input, bytesRef o_output)
 {
 	// FIXME: What with unaligned memory?
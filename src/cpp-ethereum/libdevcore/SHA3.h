@@ -38,6 +38,14 @@ bool sha3(bytesConstRef _input, bytesRef o_output);
 
 /// Calculate SHA3-256 hash of the given input, returning as a 256-bit hash.
 inline h256 sha3(bytesConstRef _input) { h256 ret; sha3(_input, ret.ref()); return ret; }
+
+/// Calculate the SHA3-256 hashes of _count independent inputs into o_outputs.
+/// Inputs shorter than one sponge block (trie keys, addresses, small nodes) are
+/// hashed four at a time with AVX2 when the CPU supports it.
+void sha3Batch(bytesConstRef const* _inputs, h256* o_outputs, size_t _count);
+
+/// @returns the name of the keccak backend selected at runtime.
+std::string sha3Implementation();
 inline SecureFixedHash<32> sha3Secure(bytesConstRef _input) { SecureFixedHash<32> ret; sha3(_input, ret.writable().ref()); return ret; }
 
 /// Calculate SHA3-256 hash of the given input, returning as a 256-bit hash.
@@ -394,6 +394,9 @@ public:
 	bool contains(bytesConstRef _key) { return Super::contains(sha3(_key)); }
 	void insert(bytesConstRef _key, bytesConstRef _value) { Super::insert(sha3(_key), _value); }
 	void remove(bytesConstRef _key) { Super::remove(sha3(_key)); }
+	/// As insert/remove, with _hash == sha3(_key) already computed by the caller (see sha3Batch).
+	void insertHashed(h256 const& _hash, bytesConstRef, bytesConstRef _value) { Super::insert(_hash, _value); }
+	void removeHashed(h256 const& _hash) { Super::remove(_hash); }
 
 	// empty from the PoV of the iterator interface; still need a basic iterator impl though.
 	class iterator
@@ -443,14 +446,16 @@ public:
 
 	std::string at(bytesConstRef _key) const { return Super::at(sha3(_key)); }
 	bool contains(bytesConstRef _key) { return Super::contains(sha3(_key)); }
-	void insert(bytesConstRef _key, bytesConstRef _value)
+	void insert(bytesConstRef _key, bytesConstRef _value) { insertHashed(sha3(_key), _key, _value); }
+	void remove(bytesConstRef _key) { removeHashed(sha3(_key)); }
+
+	/// As insert/remove, with _hash == sha3(_key) already computed by the caller (see sha3Batch).
+	void insertHashed(h256 const& _hash, bytesConstRef _key, bytesConstRef _value)
 	{
-		h256 hash = sha3(_key);
-		Super::insert(hash, _value);
-		Super::db()->insertAux(hash, _key);
+		Super::insert(_hash, _value);
+		Super::db()->insertAux(_hash, _key);
 	}
-
-	void remove(bytesConstRef _key) { Super::remove(sha3(_key)); }
+	void removeHashed(h256 const& _hash) { Super::remove(_hash); }
 
 	// iterates over <key, value> pairs
 	class iterator: public GenericTrieDB<_DB>::iterator
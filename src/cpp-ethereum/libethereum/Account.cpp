@@ -35,6 +35,35 @@ void Account::setNewCode(bytes&& _code)
 	m_codeHash = sha3(m_codeCache);
 }
 
+void Account::untouch()
+{
+	for (auto const& i: m_storageOverlay)
+		m_storageCache[i.first] = i.second;
+	m_storageOverlay.clear();
+	m_isUnchanged = true;
+}
+
+void Account::noteCommitted(h256 const& _storageRoot)
+{
+	for (auto const& i: m_storageOverlay)
+		m_storageCache[i.first] = i.second;
+	m_storageOverlay.clear();
+	m_storageRoot = _storageRoot;
+	m_hasNewCode = false;
+	m_isUnchanged = true;
+}
+
+u256 const* Account::knownStorage(u256 const& _p) const
+{
+	auto it = m_storageOverlay.find(_p);
+	if (it != m_storageOverlay.end())
+		return &it->second;
+	auto cached = m_storageCache.find(_p);
+	if (cached != m_storageCache.end())
+		return &cached->second;
+	return nullptr;
+}
+
 namespace js = json_spirit;
 
 uint64_t toUnsigned(js::mValue const& _v)
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <libdevcore/Common.h>
+#include <libdevcore/FlatHashMap.h>
 #include <libdevcore/RLP.h>
 #include <libdevcore/TrieDB.h>
 #include <libdevcore/SHA3.h>
@@ -43,7 +44,8 @@ namespace eth
  * For the account's storage, the class operates a cache. baseRoot() specifies the base state of the storage
  * given as the Trie root to be looked up in the state database. Alterations beyond this base are specified
  * in the overlay, stored in this class and retrieved with storageOverlay(). setStorage allows the overlay
- * to be altered.
+ * to be altered. Values read from the database, or committed to it, are kept apart from the overlay, so
+ * that an account can stay cached after a commit without writing them again.
  *
  * The code handling explicitly supports a two-stage commit model needed for contract-creation. When creating
  * a contract (running the initialisation code), the code of the account is considered empty. The attribute
@@ -89,7 +91,7 @@ public:
 
 
 	/// Kill this account. Useful for the suicide opcode. Following this call, isAlive() returns false.
-	void kill() { m_isAlive = false; m_storageOverlay.clear(); m_codeHash = EmptySHA3; m_storageRoot = EmptyTrie; m_balance = 0; m_nonce = 0; changed(); }
+	void kill() { m_isAlive = false; m_storageOverlay.clear(); m_storageCache.clear(); m_codeHash = EmptySHA3; m_storageRoot = EmptyTrie; m_balance = 0; m_nonce = 0; changed(); }
 
 	/// @returns true iff this object represents an account in the state. Returns false if this object
 	/// represents an account that should no longer exist in the trie (an account that never existed or was
@@ -99,7 +101,12 @@ public:
 	/// @returns true if the account is unchanged from creation.
 	bool isDirty() const { return !m_isUnchanged; }
 
-	void untouch() { m_isUnchanged = true; }
+	/// Undo the first change to the account. Anything left in the overlay has been set back to its
+	/// committed value.
+	void untouch();
+
+	/// Note that all changes have been committed to the trie, giving the new storage root.
+	void noteCommitted(h256 const& _storageRoot);
 
 	/// @returns true if the nonce, balance and code is zero / empty. Code is considered empty
 	/// during creation phase.
@@ -127,7 +134,11 @@ public:
 	h256 baseRoot() const { assert(m_storageRoot); return m_storageRoot; }
 
 	/// @returns the storage overlay as a simple hash map.
-	std::unordered_map<u256, u256> const& storageOverlay() const { return m_storageOverlay; }
+	FlatHashMap<u256, u256> const& storageOverlay() const { return m_storageOverlay; }
+
+	/// @returns the value of the storage slot @a _p if it is known without looking it up in the
+	/// database, nullptr otherwise.
+	u256 const* knownStorage(u256 const& _p) const;
 
 	/// Set a key/value pair in the account's storage. This actually goes into the overlay, for committing
 	/// to the trie later.
@@ -135,7 +146,7 @@ public:
 
 	/// Set a key/value pair in the account's storage to a value that is already present inside the
 	/// database.
-	void setStorageCache(u256 _p, u256 _v) const { const_cast<decltype(m_storageOverlay)&>(m_storageOverlay)[_p] = _v; }
+	void setStorageCache(u256 _p, u256 _v) const { const_cast<decltype(m_storageCache)&>(m_storageCache)[_p] = _v; }
 
 	/// @returns the hash of the account's code.
 	h256 codeHash() const { return m_codeHash; }
@@ -187,7 +198,10 @@ private:
 	h256 m_codeHash = EmptySHA3;
 
 	/// The map with is overlaid onto whatever storage is implied by the m_storageRoot in the trie.
-	std::unordered_map<u256, u256> m_storageOverlay;
+	FlatHashMap<u256, u256> m_storageOverlay;
+
+	/// Values of the trie at m_storageRoot that have been read or committed.
+	FlatHashMap<u256, u256> m_storageCache;
 
 	/// The associated code for this account. The SHA3 of this should be equal to m_codeHash unless m_codeHash
 	/// equals c_contractConceptionCodeHash.
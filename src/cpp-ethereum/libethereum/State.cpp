@@ -180,11 +180,7 @@ Account* State::account(Address const& _addr)
 	clearCacheIfTooLarge();
 
 	RLP state(stateBack);
-	auto i = m_cache.emplace(
-		std::piecewise_construct,
-		std::forward_as_tuple(_addr),
-		std::forward_as_tuple(state[0].toInt<u256>(), state[1].toInt<u256>(), state[2].toHash<h256>(), state[3].toHash<h256>(), Account::Unchanged)
-	);
+	auto i = m_cache.emplace(_addr, Account(state[0].toInt<u256>(), state[1].toInt<u256>(), state[2].toHash<h256>(), state[3].toHash<h256>(), Account::Unchanged));
 	m_unchangedCacheEntries.push_back(_addr);
 	return &i.first->second;
 }
@@ -213,8 +209,30 @@ void State::commit(CommitBehaviour _commitBehaviour)
 		removeEmptyAccounts();
 	m_touched += dev::eth::commit(m_cache, m_state);
 	m_changeLog.clear();
-	m_cache.clear();
-	m_unchangedCacheEntries.clear();
+	m_killedAccounts.clear();
+
+	// Keep what was committed cached for the next transactions. Accounts
+	// read from the trie are still in m_unchangedCacheEntries, created ones
+	// stay until the cache is cleared.
+	vector<Address> dead;
+	for (auto& i: m_cache)
+		if (i.second.isDirty())
+		{
+			if (!i.second.isAlive())
+				dead.push_back(i.first);
+			else
+			{
+				h256 root = i.second.baseRoot();
+				if (!i.second.storageOverlay().empty())
+					root = RLP(m_state.at(i.first))[2].toHash<h256>();
+				i.second.noteCommitted(root);
+			}
+		}
+	for (auto const& a: dead)
+	{
+		m_cache.erase(a);
+		m_nonExistingAccountsCache.insert(a);
+	}
 }
 
 unordered_map<Address, u256> State::addresses() const
@@ -238,10 +256,24 @@ void State::setRoot(h256 const& _r)
 	m_cache.clear();
 	m_unchangedCacheEntries.clear();
 	m_nonExistingAccountsCache.clear();
+	m_changeLog.clear();
+	m_killedAccounts.clear();
 //	m_touched.clear();
 	m_state.setRoot(_r);
 }
 
+void State::clearCache()
+{
+	vector<Address> unchanged;
+	for (auto const& i: m_cache)
+		if (!i.second.isDirty())
+			unchanged.push_back(i.first);
+	for (auto const& a: unchanged)
+		m_cache.erase(a);
+	m_unchangedCacheEntries.clear();
+	m_nonExistingAccountsCache.clear();
+}
+
 bool State::addressInUse(Address const& _id) const
 {
 	return !!account(_id);
@@ -275,6 +307,8 @@ void State::incNonce(Address const& _addr)
 {
 	if (Account* a = account(_addr))
 	{
+		if (!a->isDirty())
+			m_changeLog.emplace_back(Change::Touch, _addr);
 		a->incNonce();
 		m_changeLog.emplace_back(Change::Nonce, _addr);
 	}
@@ -287,13 +321,13 @@ void State::addBalance(Address const& _id, u256 const& _amount)
 {
 	if (Account* a = account(_id))
 	{
-		// Log empty account being touched. Empty touched accounts are cleared
-		// after the transaction, so this event must be also reverted.
-		// We only log the first touch (not dirty yet), and only for empty
-		// accounts, as other accounts does not matter.
+		// Log the account being touched. Empty touched accounts are cleared
+		// after the transaction, and other accounts stay cached after the
+		// commit, so this event must be also reverted. We only log the first
+		// touch (not dirty yet).
 		// TODO: to save space we can combine this event with Balance by having
 		//       Balance and Balance+Touch events.
-		if (!a->isDirty() && a->isEmpty())
+		if (!a->isDirty())
 			m_changeLog.emplace_back(Change::Touch, _id);
 
 		// Increase the account balance. This also is done for value 0 to mark
@@ -338,7 +372,11 @@ void State::createAccount(Address const& _address, Account const&& _account)
 void State::kill(Address _addr)
 {
 	if (auto a = account(_addr))
+	{
+		m_changeLog.emplace_back(Change::Kill, _addr, m_killedAccounts.size());
+		m_killedAccounts.push_back(*a);
 		a->kill();
+	}
 	// If the account is not in the db, nothing to kill.
 }
 
@@ -354,9 +392,8 @@ u256 State::storage(Address const& _id, u256 const& _key) const
 {
 	if (Account const* a = account(_id))
 	{
-		auto mit = a->storageOverlay().find(_key);
-		if (mit != a->storageOverlay().end())
-			return mit->second;
+		if (u256 const* v = a->knownStorage(_key))
+			return *v;
 
 		// Not in the storage cache - go to the DB.
 		SecureTrieDB<h256, OverlayDB> memdb(const_cast<OverlayDB*>(&m_db), a->baseRoot());			// promise we won't change the overlay! :)
@@ -371,8 +408,12 @@ u256 State::storage(Address const& _id, u256 const& _key) const
 
 void State::setStorage(Address const& _contract, u256 const& _key, u256 const& _value)
 {
-	m_changeLog.emplace_back(_contract, _key, storage(_contract, _key));
-	m_cache[_contract].setStorage(_key, _value);
+	u256 const prior = storage(_contract, _key);
+	Account& a = m_cache[_contract];
+	if (!a.isDirty())
+		m_changeLog.emplace_back(Change::Touch, _contract);
+	m_changeLog.emplace_back(_contract, _key, prior);
+	a.setStorage(_key, _value);
 }
 
 map<h256, pair<u256, u256>> State::storage(Address const& _id) const
@@ -439,7 +480,10 @@ bytes const& State::code(Address const& _addr) const
 
 void State::setNewCode(Address const& _address, bytes&& _code)
 {
-	m_cache[_address].setNewCode(std::move(_code));
+	Account& a = m_cache[_address];
+	if (!a.isDirty())
+		m_changeLog.emplace_back(Change::Touch, _address);
+	a.setNewCode(std::move(_code));
 	m_changeLog.emplace_back(Change::NewCode, _address);
 }
 
@@ -507,6 +551,10 @@ void State::rollback(size_t _savepoint)
 			account.untouch();
 			m_unchangedCacheEntries.emplace_back(change.address);
 			break;
+		case Change::Kill:
+			account = std::move(m_killedAccounts.back());
+			m_killedAccounts.pop_back();
+			break;
 		}
 		m_changeLog.pop_back();
 	}
@@ -534,7 +582,7 @@ std::pair<ExecutionResult, TransactionReceipt> State::execute(EnvInfo const& _en
 	e.finalize();
 
 	if (_p == Permanence::Reverted)
-		m_cache.clear();
+		rollback(0);
 	else
 	{
 		bool removeEmptyAccounts = _envInfo.number() >= _sealEngine.chainParams().u256Param("EIP158ForkBlock");
@@ -122,8 +122,12 @@ struct Change
 		/// New code was added to an account (by "create" message execution).
 		NewCode,
 
-		/// Account was touched for the first time.
-		Touch
+		/// Account was changed for the first time since it was committed.
+		Touch,
+
+		/// Account was killed. Change::value is the index of its prior state
+		/// in the killed accounts kept by State.
+		Kill
 	};
 
 	Kind kind;        ///< The kind of the change.
@@ -157,6 +161,10 @@ struct Change
  * In case some changes must be reverted, the changes are popped from the
  * changelog and undone. For possible atomic changes list @see Change::Kind.
  * The changelog is managed by savepoint(), rollback() and commit() methods.
+ *
+ * Committed accounts stay in the cache, unchanged, until the root is set or
+ * clearCache() is called. So nothing but the changelog may be relied on to
+ * undo changes.
  */
 class State
 {
@@ -294,6 +302,9 @@ public:
 	/// Resets any uncommitted changes to the cache.
 	void setRoot(h256 const& _root);
 
+	/// Drops the cached accounts that have no uncommitted changes.
+	void clearCache();
+
 	/// Get the account start nonce. May be required.
 	u256 const& accountStartNonce() const { return m_accountStartNonce; }
 	u256 const& requireAccountStartNonce() const;
@@ -328,7 +339,7 @@ protected: // abp
 
 	OverlayDB m_db;								///< Our overlay for the state tree.
 	SecureTrieDB<Address, OverlayDB> m_state;	///< Our state tree, as an OverlayDB DB.
-	mutable std::unordered_map<Address, Account> m_cache;	///< Our address cache. This stores the states of each address that has (or at least might have) been changed.
+	mutable FlatHashMap<Address, Account> m_cache;	///< Our address cache. This stores the states of each address that has (or at least might have) been changed, or was read since the root was set.
 	mutable std::vector<Address> m_unchangedCacheEntries;	///< Tracks entries in m_cache that can potentially be purged if it grows too large.
 	mutable std::set<Address> m_nonExistingAccountsCache;	///< Tracks addresses that are known to not exist.
 	AddressHash m_touched;						///< Tracks all addresses touched so far.
@@ -337,12 +348,13 @@ protected: // abp
 
 	friend std::ostream& operator<<(std::ostream& _out, State const& _s);
 	std::vector<detail::Change> m_changeLog;
+	std::vector<Account> m_killedAccounts;		///< Prior states of the accounts killed in m_changeLog.
 };
 
 std::ostream& operator<<(std::ostream& _out, State const& _s);
 
-template <class DB>
-AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
+template <class Cache, class DB>
+AddressHash commit(Cache const& _cache, SecureTrieDB<Address, DB>& _state)
 {
 	AddressHash ret;
 	for (auto const& i: _cache)
@@ -363,11 +375,30 @@ AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
 				else
 				{
 					SecureTrieDB<h256, DB> storageDB(_state.db(), i.second.baseRoot());
-					for (auto const& j: i.second.storageOverlay())
+					// Hash all of the slot keys up front so short keys go
+					// through the multi-buffer keccak together.
+					auto const& overlay = i.second.storageOverlay();
+					std::vector<h256> keys;
+					keys.reserve(overlay.size());
+					for (auto const& j: overlay)
+						keys.push_back(j.first);
+					std::vector<bytesConstRef> refs(keys.size());
+					std::vector<h256> hashes(keys.size());
+					for (size_t k = 0; k < keys.size(); ++k)
+						refs[k] = keys[k].ref();
+					sha3Batch(refs.data(), hashes.data(), refs.size());
+					size_t k = 0;
+					for (auto const& j: overlay)
+					{
 						if (j.second)
-							storageDB.insert(j.first, rlp(j.second));
+						{
+							bytes value = rlp(j.second);
+							storageDB.insertHashed(hashes[k], refs[k], &value);
+						}
 						else
-							storageDB.remove(j.first);
+							storageDB.removeHashed(hashes[k]);
+						++k;
+					}
 					assert(storageDB.root());
 					s.append(storageDB.root());
 				}
@@ -23,6 +23,7 @@
 
 #include <set>
 #include <functional>
+#include <memory>
 #include <boost/optional.hpp>
 #include <libdevcore/Common.h>
 #include <libdevcore/CommonData.h>
@@ -217,7 +218,7 @@ public:
 		// static_cast to be noticed when BlockHeader::gasLimit() will be
 		// changed to int64 too.
 		m_gasLimit(_current.gasLimit().convert_to<int64_t>()),
-		m_lastHashes(_lh),
+		m_lastHashes(std::make_shared<LastHashes>(_lh)),
 		m_gasUsed(_gasUsed)
 	{}
 
@@ -230,7 +231,7 @@ public:
 		// static_cast to be noticed when BlockHeader::gasLimit() will be
 		// changed to int64 too.
 		m_gasLimit(_current.gasLimit().convert_to<int64_t>()),
-		m_lastHashes(_lh),
+		m_lastHashes(std::make_shared<LastHashes>(std::move(_lh))),
 		m_gasUsed(_gasUsed)
 	{}
 
@@ -239,7 +240,7 @@ public:
 	u256 const& timestamp() const { return m_timestamp; }
 	u256 const& difficulty() const { return m_difficulty; }
 	int64_t gasLimit() const { return m_gasLimit; }
-	LastHashes const& lastHashes() const { return m_lastHashes; }
+	LastHashes const& lastHashes() const { return *m_lastHashes; }
 	u256 const& gasUsed() const { return m_gasUsed; }
 
 	void setNumber(u256 const& _v) { m_number = _v; }
@@ -247,15 +248,19 @@ public:
 	void setTimestamp(u256 const& _v) { m_timestamp = _v; }
 	void setDifficulty(u256 const& _v) { m_difficulty = _v; }
 	void setGasLimit(int64_t _v) { m_gasLimit = _v; }
-	void setLastHashes(LastHashes&& _lh) { m_lastHashes = _lh; }
+	void setLastHashes(LastHashes&& _lh) { m_lastHashes = std::make_shared<LastHashes>(std::move(_lh)); }
+	/// Share hashes that stay the same for every execution on top of one block. // abp
+	void setLastHashes(std::shared_ptr<LastHashes const> const& _lh) { m_lastHashes = _lh; }
 
 private:
+	static std::shared_ptr<LastHashes const> const& noLastHashes() { static std::shared_ptr<LastHashes const> const s_none = std::make_shared<LastHashes>(); return s_none; }
+
 	u256 m_number;
 	Address m_author;
 	u256 m_timestamp;
 	u256 m_difficulty;
 	int64_t m_gasLimit;
-	LastHashes m_lastHashes;
+	std::shared_ptr<LastHashes const> m_lastHashes = noLastHashes();
 	u256 m_gasUsed;
 };
 
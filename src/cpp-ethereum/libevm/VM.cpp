@@ -104,11 +104,23 @@ uint64_t VM::gasForMem(u512 _size)
 
 void VM::updateIOGas()
 {
-	if (m_io_gas < m_runGas)
+	if (m_PC >= m_blockEnd && m_io_gas < m_runGas)
 		throwOutOfGas();
 	m_io_gas -= m_runGas;
 }
 
+void VM::enterBlock(VMBasicBlock const& _block)
+{
+	// If gas and stack suffice for the whole block no instruction in it can
+	// fail their checks, so they are skipped up to its end. Otherwise the
+	// block runs checked as usual and fails at the same instruction.
+	ptrdiff_t const size = 1 + m_SP - m_stack;
+	if (size >= _block.stackReq && size + _block.stackGrowth <= 1024 && m_io_gas >= _block.gas)
+		m_blockEnd = _block.end;
+	else
+		m_blockEnd = 0;
+}
+
 void VM::updateGas()
 {
 	if (m_newMemSize > m_mem.size())
@@ -138,7 +150,10 @@ void VM::fetchInstruction()
 {
 	m_OP = Instruction(m_code[m_PC]);
 	const InstructionMetric& metric = c_metrics[static_cast<size_t>(m_OP)];
-	checkStack(metric.args, metric.ret);
+	if (uint32_t block = m_blockAt[m_PC])
+		enterBlock(m_blocks[block - 1]);
+	if (m_PC >= m_blockEnd)
+		checkStack(metric.args, metric.ret);
 
 	// FEES...
 	m_runGas = toInt63(m_schedule->tierStepGas[static_cast<unsigned>(metric.gasPriceTier)]);
@@ -228,7 +243,8 @@ void VM::interpretCases()
 
 			size_t b = (size_t)*m_SP--;
 			size_t s = (size_t)*m_SP--;
-			m_output = owning_bytes_ref{std::move(m_mem), b, s};
+			// memory belongs to the arena, the output is copied out of it
+			m_output = owning_bytes_ref{s ? bytes(m_mem.begin() + b, m_mem.begin() + b + s) : bytes(), 0, s};
 			m_bounce = 0;
 		}
 		BREAK
@@ -28,6 +28,7 @@
 #include <libdevcore/SHA3.h>
 #include <libethcore/BlockHeader.h>
 #include "VMFace.h"
+#include "VMFrame.h"
 
 namespace dev
 {
@@ -68,11 +69,14 @@ public:
 	void validateSubroutine(uint64_t _PC, uint64_t* _RP, u256* _SP);
 #endif
 
-	bytes const& memory() const { return m_mem; }
+	bytesConstRef memory() const { return bytesConstRef(m_mem.data(), m_mem.size()); }
 	u256s stack() const { assert(m_stack <= m_SP + 1); return u256s(m_stack, m_SP + 1); };
 
 private:
 
+	// buffers of this call depth, declared first to outlive the memory
+	VMFrame m_frame;
+
 	u256* io_gas = 0;
 	uint64_t m_io_gas = 0;
 	ExtVMFace* m_ext = 0;
@@ -95,14 +99,14 @@ private:
 	owning_bytes_ref m_output;
 
 	// space for memory
-	bytes m_mem;
+	VMMemory m_mem;
 
 	// space for code and pointer to data
-	bytes m_codeSpace;
+	bytes& m_codeSpace = m_frame.space().code;
 	byte* m_code = nullptr;
 
 	// space for stack and pointer to data
-	u256 m_stackSpace[1025];
+	u256* m_stackSpace = m_frame.space().stack;
 	u256* m_stack = m_stackSpace + 1;
 	ptrdiff_t stackSize() { return m_SP - m_stack; }
 	
@@ -116,7 +120,7 @@ private:
 #endif
 
 	// constant pool
-	u256 m_pool[256];
+	u256 (&m_pool)[256] = m_frame.space().pool;
 
 	// interpreter state
 	Instruction m_OP;                   // current operator
@@ -131,9 +135,16 @@ private:
 	uint64_t m_newMemSize = 0;
 	uint64_t m_copyMemSize = 0;
 
+	// basic blocks of statically priced instructions
+	std::vector<VMBasicBlock>& m_blocks = m_frame.space().blocks;
+	std::vector<uint32_t>& m_blockAt = m_frame.space().blockAt;    // 1 + index in m_blocks at pcs starting a block
+	uint64_t m_blockEnd = 0;            // gas and stack were checked on block entry below this pc
+
 	// initialize interpreter
 	void initEntry();
 	void optimize();
+	void findBlocks();
+	void enterBlock(VMBasicBlock const& _block);
 
 	// interpreter loop & switch
 	void interpretCases();
@@ -154,7 +165,7 @@ private:
 	void reportStackUse();
 
 	std::vector<uint64_t> m_beginSubs;
-	std::vector<uint64_t> m_jumpDests;
+	std::vector<uint64_t>& m_jumpDests = m_frame.space().jumpDests;
 	int64_t verifyJumpDest(u256 const& _dest, bool _throw = true);
 
 	int poolConstant(const u256&);
@@ -26,6 +26,7 @@ namespace eth
 //
 // EVM_SWITCH_DISPATCH    - dispatch via loop and switch
 // EVM_JUMP_DISPATCH      - dispatch via a jump table - available only on GCC
+//                          and Clang, the default there
 //
 // EVM_USE_CONSTANT_POOL  - 256 constants unpacked and ready to assign to stack
 //
@@ -35,7 +36,7 @@ namespace eth
 
 #ifndef EVM_JUMP_DISPATCH
 	#ifdef __GNUC__
-		#define EVM_JUMP_DISPATCH false
+		#define EVM_JUMP_DISPATCH true
 	#else
 		#define EVM_JUMP_DISPATCH false
 	#endif
@@ -0,0 +1,112 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file VMFrame.cpp
+ */
+
+#include "VMFrame.h"
+#include <algorithm>
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+namespace
+{
+
+struct FramePool
+{
+	// enough for ordinary call depths, deeper recursion allocates again
+	static size_t const c_maxFree = 64;
+
+	vector<unique_ptr<VMFrameSpace>> free;
+	unsigned live = 0;
+	VMArena arena;
+};
+
+FramePool& localPool()
+{
+	static thread_local FramePool s_pool;
+	return s_pool;
+}
+
+}
+
+void* VMArena::allocate(size_t _size)
+{
+	size_t const size = aligned(_size);
+	if (size > size_t(m_end - m_next))
+	{
+		size_t const chunkSize = size < c_chunkSize ? c_chunkSize : size;
+		m_chunks.emplace_back(unique_ptr<byte[]>(new byte[chunkSize]), chunkSize);
+		m_next = m_chunks.back().first.get();
+		m_end = m_next + chunkSize;
+	}
+	void* p = m_next;
+	m_next += size;
+	return p;
+}
+
+void VMArena::deallocate(void* _p, size_t _size)
+{
+	if (static_cast<byte*>(_p) + aligned(_size) == m_next)
+		m_next = static_cast<byte*>(_p);
+}
+
+void VMArena::reset()
+{
+	if (m_chunks.empty())
+		return;
+	auto largest = max_element(m_chunks.begin(), m_chunks.end(), [](decltype(m_chunks)::value_type const& _a, decltype(m_chunks)::value_type const& _b) { return _a.second < _b.second; });
+	auto kept = std::move(*largest);
+	m_chunks.clear();
+	if (kept.second <= c_maxKeptSize)
+		m_chunks.push_back(std::move(kept));
+	m_next = m_chunks.empty() ? nullptr : m_chunks.back().first.get();
+	m_end = m_chunks.empty() ? nullptr : m_next + m_chunks.back().second;
+}
+
+VMArena& VMArena::local()
+{
+	return localPool().arena;
+}
+
+VMFrame::VMFrame()
+{
+	FramePool& pool = localPool();
+	if (pool.free.empty())
+		m_space.reset(new VMFrameSpace);
+	else
+	{
+		m_space = std::move(pool.free.back());
+		pool.free.pop_back();
+		// below the stack, read as zero by some malformed jumps
+		m_space->stack[0] = 0;
+	}
+	++pool.live;
+}
+
+VMFrame::~VMFrame()
+{
+	FramePool& pool = localPool();
+	m_space->code.clear();
+	m_space->jumpDests.clear();
+	m_space->blocks.clear();
+	m_space->blockAt.clear();
+	if (pool.free.size() < FramePool::c_maxFree)
+		pool.free.push_back(std::move(m_space));
+	if (--pool.live == 0)
+		pool.arena.reset();
+}
@@ -0,0 +1,117 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file VMFrame.h
+ * Buffers of interpreter frames, recycled per thread across call depth.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <libdevcore/Common.h>
+
+namespace dev
+{
+namespace eth
+{
+
+/// Run of instructions priced by their tier alone, entered only at its start.
+struct VMBasicBlock
+{
+	uint64_t end;       // pc after the last instruction
+	uint64_t gas;       // step gas of all instructions
+	int stackReq;       // stack items needed on entry
+	int stackGrowth;    // most items above the entry size
+};
+
+/// Everything a VM needs per call that does not depend on the code size of
+/// the first call at that depth. Taken from and returned to a per thread
+/// pool, so nested calls neither allocate nor zero it again.
+struct VMFrameSpace
+{
+	u256 stack[1025];
+	u256 pool[256];
+	bytes code;
+	std::vector<uint64_t> jumpDests;
+	std::vector<VMBasicBlock> blocks;
+	std::vector<uint32_t> blockAt;
+};
+
+/// Bump allocator for the EVM memory of all frames on one thread. Freeing
+/// the most recent allocation rolls it back, anything else is released at
+/// once when the outermost frame ends.
+class VMArena
+{
+public:
+	void* allocate(size_t _size);
+	void deallocate(void* _p, size_t _size);
+
+	/// Forget all allocations, keeping one chunk for the next transaction.
+	void reset();
+
+	/// @returns the thread's arena.
+	static VMArena& local();
+
+private:
+	static size_t const c_chunkSize = 64 * 1024;
+	static size_t const c_maxKeptSize = 16 * 1024 * 1024;
+
+	static size_t aligned(size_t _size) { return (_size + 15) & ~size_t(15); }
+
+	std::vector<std::pair<std::unique_ptr<byte[]>, size_t>> m_chunks;
+	byte* m_next = nullptr;
+	byte* m_end = nullptr;
+};
+
+template <class T>
+class VMArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	VMArenaAllocator() = default;
+	template <class U> VMArenaAllocator(VMArenaAllocator<U> const&) {}
+
+	T* allocate(size_t _n) { return static_cast<T*>(VMArena::local().allocate(_n * sizeof(T))); }
+	void deallocate(T* _p, size_t _n) { VMArena::local().deallocate(_p, _n * sizeof(T)); }
+
+	template <class U> bool operator==(VMArenaAllocator<U> const&) const { return true; }
+	template <class U> bool operator!=(VMArenaAllocator<U> const&) const { return false; }
+};
+
+/// EVM memory of one frame.
+using VMMemory = std::vector<byte, VMArenaAllocator<byte>>;
+
+/// A VM's lease on frame space. When the last lease on the thread ends, the
+/// transaction is over and the thread's arena is reset.
+class VMFrame
+{
+public:
+	VMFrame();
+	~VMFrame();
+
+	VMFrame(VMFrame const&) = delete;
+	VMFrame& operator=(VMFrame const&) = delete;
+
+	VMFrameSpace& space() { return *m_space; }
+
+private:
+	std::unique_ptr<VMFrameSpace> m_space;
+};
+
+}
+}
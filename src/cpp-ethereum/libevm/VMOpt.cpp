@@ -249,6 +249,107 @@ void VM::optimize()
 	}
 	TRACE_STR(1, "Finished optimizations")
 #endif	
+
+	findBlocks();
+}
+
+// Instructions whose gas is their tier's step gas and which touch no memory
+static bool isStaticallyPriced(Instruction _op, InstructionMetric const& _metric)
+{
+	switch (_op)
+	{
+	case Instruction::JUMPDEST:
+		return true;
+	case Instruction::MLOAD:
+	case Instruction::MSTORE:
+	case Instruction::MSTORE8:
+	case Instruction::CALLDATACOPY:
+	case Instruction::CODECOPY:
+	case Instruction::RETURN:
+	case Instruction::JUMPTO:
+	case Instruction::JUMPIF:
+	case Instruction::JUMPV:
+	case Instruction::JUMPSUB:
+	case Instruction::JUMPSUBV:
+	case Instruction::RETURNSUB:
+	case Instruction::BEGINSUB:
+	case Instruction::BEGINDATA:
+	case Instruction::BAD:
+		return false;
+	default:
+		return _metric.gasPriceTier < Tier::Special;
+	}
+}
+
+//
+// Split the code into basic blocks of statically priced instructions. Control
+// only enters a block at its start, by falling through or by jumping to its
+// JUMPDEST, so the interpreter can check gas and stack once for all of it.
+//
+void VM::findBlocks()
+{
+	size_t const nBytes = m_ext->code.size();
+	m_blocks.clear();
+	m_blockAt.assign(m_codeSpace.size(), 0);
+
+	TRACE_STR(1, "Find basic blocks")
+	VMBasicBlock block;
+	uint64_t start = 0;
+	int height = 0;
+	bool open = false;
+	auto closeBlock = [&](uint64_t _end)
+	{
+		if (!open)
+			return;
+		block.end = _end;
+		m_blocks.push_back(block);
+		m_blockAt[start] = m_blocks.size();
+		open = false;
+	};
+
+	uint64_t pc = 0;
+	while (pc < nBytes)
+	{
+		Instruction op = Instruction(m_code[pc]);
+		InstructionMetric const& metric = c_metrics[static_cast<size_t>(op)];
+		if (op == Instruction::JUMPDEST || !isStaticallyPriced(op, metric))
+			closeBlock(pc);
+		if (!isStaticallyPriced(op, metric))
+		{
+			++pc;
+			continue;
+		}
+		if (!open)
+		{
+			block = VMBasicBlock{0, 0, 0, 0};
+			start = pc;
+			height = 0;
+			open = true;
+		}
+
+		// same gas and stack checks as fetchInstruction() and the cases make
+		block.gas += op == Instruction::JUMPDEST ? 1 : m_schedule->tierStepGas[static_cast<unsigned>(metric.gasPriceTier)];
+		block.stackReq = max(block.stackReq, metric.args - height);
+		block.stackGrowth = max(block.stackGrowth, height - metric.args + metric.ret);
+		height += metric.ret - metric.args;
+
+		if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
+			pc += (byte)op - (byte)Instruction::PUSH1 + 2;
+		else if (op == Instruction::PUSHC)
+			pc += 2 + m_code[pc + 2];
+		else
+			++pc;
+
+		if (
+			op == Instruction::JUMP ||
+			op == Instruction::JUMPI ||
+			op == Instruction::JUMPC ||
+			op == Instruction::JUMPCI ||
+			op == Instruction::STOP
+		)
+			closeBlock(pc);
+	}
+	closeBlock(pc);
 }
 
 
@@ -0,0 +1,159 @@
+// Copyright (c) 2018 The Abp Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+namespace keccak_avx2 {
+namespace {
+
+static const uint64_t RC[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+
+/** Keccak-256 rate in bytes. */
+static const size_t RATE = 136;
+
+#define XOR(x, y) _mm256_xor_si256(x, y)
+#define ANDN(x, y) _mm256_andnot_si256(x, y)
+#define ROL(x, s) _mm256_or_si256(_mm256_slli_epi64(x, s), _mm256_srli_epi64(x, 64 - (s)))
+
+/** One Keccak-f[1600] round on four independent states, one per 64-bit lane. */
+#define KECCAK_ROUND4(A, E, rc) \
+    Ca = XOR(XOR(XOR(A##ba, A##ga), XOR(A##ka, A##ma)), A##sa); \
+    Ce = XOR(XOR(XOR(A##be, A##ge), XOR(A##ke, A##me)), A##se); \
+    Ci = XOR(XOR(XOR(A##bi, A##gi), XOR(A##ki, A##mi)), A##si); \
+    Co = XOR(XOR(XOR(A##bo, A##go), XOR(A##ko, A##mo)), A##so); \
+    Cu = XOR(XOR(XOR(A##bu, A##gu), XOR(A##ku, A##mu)), A##su); \
+    Da = XOR(Cu, ROL(Ce, 1)); \
+    De = XOR(Ca, ROL(Ci, 1)); \
+    Di = XOR(Ce, ROL(Co, 1)); \
+    Do = XOR(Ci, ROL(Cu, 1)); \
+    Du = XOR(Co, ROL(Ca, 1)); \
+    \
+    Ba = XOR(A##ba, Da); \
+    Be = ROL(XOR(A##ge, De), 44); \
+    Bi = ROL(XOR(A##ki, Di), 43); \
+    Bo = ROL(XOR(A##mo, Do), 21); \
+    Bu = ROL(XOR(A##su, Du), 14); \
+    E##ba = XOR(XOR(Ba, ANDN(Be, Bi)), _mm256_set1_epi64x(rc)); \
+    E##be = XOR(Be, ANDN(Bi, Bo)); \
+    E##bi = XOR(Bi, ANDN(Bo, Bu)); \
+    E##bo = XOR(Bo, ANDN(Bu, Ba)); \
+    E##bu = XOR(Bu, ANDN(Ba, Be)); \
+    \
+    Ba = ROL(XOR(A##bo, Do), 28); \
+    Be = ROL(XOR(A##gu, Du), 20); \
+    Bi = ROL(XOR(A##ka, Da), 3); \
+    Bo = ROL(XOR(A##me, De), 45); \
+    Bu = ROL(XOR(A##si, Di), 61); \
+    E##ga = XOR(Ba, ANDN(Be, Bi)); \
+    E##ge = XOR(Be, ANDN(Bi, Bo)); \
+    E##gi = XOR(Bi, ANDN(Bo, Bu)); \
+    E##go = XOR(Bo, ANDN(Bu, Ba)); \
+    E##gu = XOR(Bu, ANDN(Ba, Be)); \
+    \
+    Ba = ROL(XOR(A##be, De), 1); \
+    Be = ROL(XOR(A##gi, Di), 6); \
+    Bi = ROL(XOR(A##ko, Do), 25); \
+    Bo = ROL(XOR(A##mu, Du), 8); \
+    Bu = ROL(XOR(A##sa, Da), 18); \
+    E##ka = XOR(Ba, ANDN(Be, Bi)); \
+    E##ke = XOR(Be, ANDN(Bi, Bo)); \
+    E##ki = XOR(Bi, ANDN(Bo, Bu)); \
+    E##ko = XOR(Bo, ANDN(Bu, Ba)); \
+    E##ku = XOR(Bu, ANDN(Ba, Be)); \
+    \
+    Ba = ROL(XOR(A##bu, Du), 27); \
+    Be = ROL(XOR(A##ga, Da), 36); \
+    Bi = ROL(XOR(A##ke, De), 10); \
+    Bo = ROL(XOR(A##mi, Di), 15); \
+    Bu = ROL(XOR(A##so, Do), 56); \
+    E##ma = XOR(Ba, ANDN(Be, Bi)); \
+    E##me = XOR(Be, ANDN(Bi, Bo)); \
+    E##mi = XOR(Bi, ANDN(Bo, Bu)); \
+    E##mo = XOR(Bo, ANDN(Bu, Ba)); \
+    E##mu = XOR(Bu, ANDN(Ba, Be)); \
+    \
+    Ba = ROL(XOR(A##bi, Di), 62); \
+    Be = ROL(XOR(A##go, Do), 55); \
+    Bi = ROL(XOR(A##ku, Du), 39); \
+    Bo = ROL(XOR(A##ma, Da), 41); \
+    Bu = ROL(XOR(A##se, De), 2); \
+    E##sa = XOR(Ba, ANDN(Be, Bi)); \
+    E##se = XOR(Be, ANDN(Bi, Bo)); \
+    E##si = XOR(Bi, ANDN(Bo, Bu)); \
+    E##so = XOR(Bo, ANDN(Bu, Ba)); \
+    E##su = XOR(Bu, ANDN(Ba, Be));
+
+void KeccakF1600_4way(__m256i* s)
+{
+    __m256i Aba = s[0], Abe = s[1], Abi = s[2], Abo = s[3], Abu = s[4];
+    __m256i Aga = s[5], Age = s[6], Agi = s[7], Ago = s[8], Agu = s[9];
+    __m256i Aka = s[10], Ake = s[11], Aki = s[12], Ako = s[13], Aku = s[14];
+    __m256i Ama = s[15], Ame = s[16], Ami = s[17], Amo = s[18], Amu = s[19];
+    __m256i Asa = s[20], Ase = s[21], Asi = s[22], Aso = s[23], Asu = s[24];
+    __m256i Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+    __m256i Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+    __m256i Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+
+    for (int i = 0; i < 24; i += 2) {
+        KECCAK_ROUND4(A, E, RC[i])
+        KECCAK_ROUND4(E, A, RC[i + 1])
+    }
+
+    s[0] = Aba; s[1] = Abe; s[2] = Abi; s[3] = Abo;
+}
+
+#undef KECCAK_ROUND4
+#undef ROL
+#undef ANDN
+#undef XOR
+
+}
+
+/**
+ * Keccak-256 (the Ethereum SHA3 variant) of four independent inputs, each of
+ * which must fit in a single sponge block (len[i] < 136). Writes four 32-byte
+ * digests to out.
+ */
+void Keccak256_4way(unsigned char* out, const unsigned char* const* in, const size_t* len)
+{
+    alignas(32) uint64_t block[4][RATE / 8];
+    for (int j = 0; j < 4; ++j) {
+        memset(block[j], 0, RATE);
+        if (len[j]) memcpy(block[j], in[j], len[j]);
+        ((unsigned char*)block[j])[len[j]] ^= 0x01;
+        ((unsigned char*)block[j])[RATE - 1] ^= 0x80;
+    }
+
+    __m256i s[25];
+    for (size_t i = 0; i < RATE / 8; ++i) {
+        s[i] = _mm256_set_epi64x(block[3][i], block[2][i], block[1][i], block[0][i]);
+    }
+    for (size_t i = RATE / 8; i < 25; ++i) {
+        s[i] = _mm256_setzero_si256();
+    }
+
+    KeccakF1600_4way(s);
+
+    alignas(32) uint64_t lanes[4];
+    for (int i = 0; i < 4; ++i) {
+        _mm256_store_si256((__m256i*)lanes, s[i]);
+        for (int j = 0; j < 4; ++j) {
+            memcpy(out + 32 * j + 8 * i, &lanes[j], 8);
+        }
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+// Copyright (c) 2017-2020 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/muhash.h>
+
+#include <crypto/chacha20.h>
+#include <crypto/common.h>
+#include <crypto/sha256.h>
+
+#include <limits>
+
+namespace {
+
+typedef Num3072::limb_t limb_t;
+typedef Num3072::double_limb_t double_limb_t;
+constexpr int LIMB_SIZE = Num3072::LIMB_SIZE;
+constexpr int LIMBS = Num3072::LIMBS;
+constexpr limb_t LIMB_MAX = std::numeric_limits<limb_t>::max();
+/** 2^3072 - 1103717 is the largest 3072-bit safe prime, this is 2^3072 minus it. */
+constexpr limb_t MAX_PRIME_DIFF = 1103717;
+
+limb_t ReadLimb(const unsigned char* ptr)
+{
+    return LIMB_SIZE == 64 ? ReadLE64(ptr) : ReadLE32(ptr);
+}
+
+void WriteLimb(unsigned char* ptr, limb_t x)
+{
+    if (LIMB_SIZE == 64) {
+        WriteLE64(ptr, x);
+    } else {
+        WriteLE32(ptr, x);
+    }
+}
+
+} // namespace
+
+Num3072::Num3072(const unsigned char (&data)[BYTE_SIZE])
+{
+    for (int i = 0; i < LIMBS; ++i) {
+        limbs[i] = ReadLimb(data + i * (LIMB_SIZE / 8));
+    }
+}
+
+void Num3072::SetToOne()
+{
+    limbs[0] = 1;
+    for (int i = 1; i < LIMBS; ++i) {
+        limbs[i] = 0;
+    }
+}
+
+/** Whether this is p or above, which can only be less than 2^3072 - p above. */
+bool Num3072::IsOverflow() const
+{
+    if (limbs[0] <= LIMB_MAX - MAX_PRIME_DIFF) return false;
+    for (int i = 1; i < LIMBS; ++i) {
+        if (limbs[i] != LIMB_MAX) return false;
+    }
+    return true;
+}
+
+/** Subtract p from a number that IsOverflow, i.e. add 2^3072 - p and drop the carry. */
+void Num3072::FullReduce()
+{
+    double_limb_t t = MAX_PRIME_DIFF;
+    for (int i = 0; i < LIMBS; ++i) {
+        t += limbs[i];
+        limbs[i] = (limb_t)t;
+        t >>= LIMB_SIZE;
+    }
+}
+
+void Num3072::Multiply(const Num3072& a)
+{
+    // Schoolbook product into 6144 bits. The limbs are only written once the
+    // product is complete, so a may be this number itself.
+    limb_t tmp[2 * LIMBS] = {};
+    for (int i = 0; i < LIMBS; ++i) {
+        limb_t carry = 0;
+        for (int j = 0; j < LIMBS; ++j) {
+            double_limb_t t = (double_limb_t)limbs[i] * a.limbs[j] + tmp[i + j] + carry;
+            tmp[i + j] = (limb_t)t;
+            carry = (limb_t)(t >> LIMB_SIZE);
+        }
+        tmp[i + LIMBS] = carry;
+    }
+
+    // 2^3072 is MAX_PRIME_DIFF modulo p, so fold the upper half onto the lower
+    // one. What carries out of that is below 2^21 and folds again; it can only
+    // carry out once more if the result was all but 2^3072, leaving it tiny.
+    limb_t carry = 0;
+    for (int j = 0; j < LIMBS; ++j) {
+        double_limb_t t = (double_limb_t)tmp[LIMBS + j] * MAX_PRIME_DIFF + tmp[j] + carry;
+        limbs[j] = (limb_t)t;
+        carry = (limb_t)(t >> LIMB_SIZE);
+    }
+    while (carry) {
+        double_limb_t t = (double_limb_t)carry * MAX_PRIME_DIFF;
+        for (int j = 0; j < LIMBS; ++j) {
+            t += limbs[j];
+            limbs[j] = (limb_t)t;
+            t >>= LIMB_SIZE;
+        }
+        carry = (limb_t)t;
+    }
+    if (IsOverflow()) FullReduce();
+}
+
+Num3072 Num3072::GetInverse() const
+{
+    // By Fermat's little theorem the inverse is this^(p - 2). The exponent is
+    // 2^3072 - MAX_PRIME_DIFF - 2: all ones but for the lowest limb. Raise to
+    // it four bits at a time from a table of the first 16 powers.
+    Num3072 table[16];
+    table[1] = *this;
+    for (int i = 2; i < 16; ++i) {
+        table[i] = table[i - 1];
+        table[i].Multiply(*this);
+    }
+
+    Num3072 r;
+    for (int i = LIMBS - 1; i >= 0; --i) {
+        limb_t e = i == 0 ? LIMB_MAX - MAX_PRIME_DIFF - 1 : LIMB_MAX;
+        for (int bit = LIMB_SIZE - 4; bit >= 0; bit -= 4) {
+            for (int k = 0; k < 4; ++k) {
+                r.Multiply(r);
+            }
+            limb_t window = (e >> bit) & 15;
+            if (window) r.Multiply(table[window]);
+        }
+    }
+    return r;
+}
+
+void Num3072::Divide(const Num3072& a)
+{
+    if (IsOverflow()) FullReduce();
+    Multiply(a.GetInverse());
+}
+
+void Num3072::ToBytes(unsigned char (&out)[BYTE_SIZE]) const
+{
+    for (int i = 0; i < LIMBS; ++i) {
+        WriteLimb(out + i * (LIMB_SIZE / 8), limbs[i]);
+    }
+}
+
+Num3072 MuHash3072::ToNum3072(const unsigned char* data, size_t len)
+{
+    // Expand the SHA256 of the element to 3072 bits with ChaCha20. The result
+    // may exceed p, which is harmless and happens with negligible probability.
+    unsigned char key[CSHA256::OUTPUT_SIZE];
+    CSHA256().Write(data, len).Finalize(key);
+    unsigned char tmp[Num3072::BYTE_SIZE];
+    ChaCha20(key, sizeof(key)).Output(tmp, sizeof(tmp));
+    return Num3072(tmp);
+}
+
+MuHash3072::MuHash3072(const unsigned char* data, size_t len)
+{
+    numerator = ToNum3072(data, len);
+}
+
+MuHash3072& MuHash3072::Insert(const unsigned char* data, size_t len)
+{
+    numerator.Multiply(ToNum3072(data, len));
+    return *this;
+}
+
+MuHash3072& MuHash3072::Remove(const unsigned char* data, size_t len)
+{
+    denominator.Multiply(ToNum3072(data, len));
+    return *this;
+}
+
+MuHash3072& MuHash3072::operator*=(const MuHash3072& mul)
+{
+    numerator.Multiply(mul.numerator);
+    denominator.Multiply(mul.denominator);
+    return *this;
+}
+
+MuHash3072& MuHash3072::operator/=(const MuHash3072& div)
+{
+    numerator.Multiply(div.denominator);
+    denominator.Multiply(div.numerator);
+    return *this;
+}
+
+void MuHash3072::Finalize(unsigned char out[32])
+{
+    numerator.Divide(denominator);
+    denominator.SetToOne();
+
+    unsigned char data[Num3072::BYTE_SIZE];
+    numerator.ToBytes(data);
+    CSHA256().Write(data, sizeof(data)).Finalize(out);
+}
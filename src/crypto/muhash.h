@@ -0,0 +1,114 @@
+// Copyright (c) 2017-2020 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_MUHASH_H
+#define BITCOIN_CRYPTO_MUHASH_H
+
+#if defined(HAVE_CONFIG_H)
+#include <config/bitcoin-config.h>
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/** A class representing numbers modulo 2^3072 - 1103717. */
+class Num3072
+{
+public:
+    static constexpr size_t BYTE_SIZE = 384;
+
+#ifdef __SIZEOF_INT128__
+    typedef unsigned __int128 double_limb_t;
+    typedef uint64_t limb_t;
+    static constexpr int LIMBS = 48;
+    static constexpr int LIMB_SIZE = 64;
+#else
+    typedef uint64_t double_limb_t;
+    typedef uint32_t limb_t;
+    static constexpr int LIMBS = 96;
+    static constexpr int LIMB_SIZE = 32;
+#endif
+    limb_t limbs[LIMBS];
+
+    /** Construct the number 1. */
+    Num3072() { SetToOne(); }
+    /** Construct from the little-endian byte representation. */
+    explicit Num3072(const unsigned char (&data)[BYTE_SIZE]);
+
+    void SetToOne();
+    void Multiply(const Num3072& a);
+    void Divide(const Num3072& a);
+    void ToBytes(unsigned char (&out)[BYTE_SIZE]) const;
+
+private:
+    bool IsOverflow() const;
+    void FullReduce();
+    Num3072 GetInverse() const;
+};
+
+/** A rolling hash of a set of byte strings, based on multiplication modulo a
+ *  3072-bit prime.
+ *
+ *  Every element is hashed to a number in the group, and the hash of the set
+ *  is the product of the numbers of its elements. Because the product does not
+ *  depend on the order of the factors, elements can be added and removed in
+ *  any order, and two sets can be combined by multiplying their hashes. This
+ *  is what allows the hash of the UTXO set to be maintained block by block,
+ *  while the serialized hash has to be recomputed over the whole set.
+ *
+ *  Removals are collected in a separate denominator so that only Finalize has
+ *  to compute a modular inverse.
+ *
+ *  See https://cseweb.ucsd.edu/~mihir/papers/inchash.pdf for the construction.
+ */
+class MuHash3072
+{
+private:
+    Num3072 numerator;
+    Num3072 denominator;
+
+    static Num3072 ToNum3072(const unsigned char* data, size_t len);
+
+public:
+    /** Construct the hash of the empty set. */
+    MuHash3072() {}
+    /** Construct the hash of the set holding one element. */
+    MuHash3072(const unsigned char* data, size_t len);
+
+    /** Add an element to the set. */
+    MuHash3072& Insert(const unsigned char* data, size_t len);
+    /** Remove an element from the set. */
+    MuHash3072& Remove(const unsigned char* data, size_t len);
+
+    /** Add all elements of another set. */
+    MuHash3072& operator*=(const MuHash3072& mul);
+    /** Remove all elements of another set. */
+    MuHash3072& operator/=(const MuHash3072& div);
+
+    /** Compute the 32-byte hash of the set. This normalizes the internal
+     *  state, so it costs one modular inverse. */
+    void Finalize(unsigned char out[32]);
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        unsigned char data[Num3072::BYTE_SIZE];
+        numerator.ToBytes(data);
+        s.write((const char*)data, sizeof(data));
+        denominator.ToBytes(data);
+        s.write((const char*)data, sizeof(data));
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        unsigned char data[Num3072::BYTE_SIZE];
+        s.read((char*)data, sizeof(data));
+        numerator = Num3072(data);
+        s.read((char*)data, sizeof(data));
+        denominator = Num3072(data);
+    }
+};
+
+#endif // BITCOIN_CRYPTO_MUHASH_H
@@ -26,9 +26,30 @@ public:
     CSHA256& Reset();
 };
 
-/** Autodetect the best available SHA256 implementation.
- *  Returns the name of the implementation.
+namespace sha256_implementation {
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_SSE4 = 1 << 0,
+    USE_AVX2 = 1 << 1,
+    USE_SHANI = 1 << 2,
+    USE_SSE4_AND_AVX2 = USE_SSE4 | USE_AVX2,
+    USE_SSE4_AND_SHANI = USE_SSE4 | USE_SHANI,
+    USE_ALL = USE_SSE4 | USE_AVX2 | USE_SHANI,
+};
+}
+
+/** Autodetect the best available SHA256 implementation, restricted to the
+ *  instruction sets allowed by use_implementation (used by benchmarks to
+ *  compare kernels). Returns the name of the implementation.
+ */
+std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implementation = sha256_implementation::USE_ALL);
+
+/** Compute multiple double-SHA256's of 64-byte blobs.
+ *  output:  pointer to a blocks*32 byte output buffer
+ *  input:   pointer to a blocks*64 byte input buffer
+ *  blocks:  the number of hashes to compute.
+ *  The output may alias the start of the input (used to compute merkle levels in place).
  */
-std::string SHA256AutoDetect();
+void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
 #endif // BITCOIN_CRYPTO_SHA256_H
@@ -0,0 +1,122 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+
+namespace sha256d64_avx2 {
+namespace {
+
+static const uint32_t K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul};
+
+static const uint32_t INIT[8] = {0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul};
+
+__m256i inline K32(uint32_t x) { return _mm256_set1_epi32(x); }
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z) { return Add(Add(x, y), z); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w) { return Add(Add(x, y), Add(z, w)); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z) { return Xor(Xor(x, y), z); }
+__m256i inline Or(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+__m256i inline And(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+__m256i inline ShR(__m256i x, int n) { return _mm256_srli_epi32(x, n); }
+__m256i inline ShL(__m256i x, int n) { return _mm256_slli_epi32(x, n); }
+__m256i inline RotR(__m256i x, int n) { return Or(ShR(x, n), ShL(x, 32 - n)); }
+
+__m256i inline Ch(__m256i x, __m256i y, __m256i z) { return Xor(z, And(x, Xor(y, z))); }
+__m256i inline Maj(__m256i x, __m256i y, __m256i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m256i inline Sigma0(__m256i x) { return Xor(RotR(x, 2), RotR(x, 13), RotR(x, 22)); }
+__m256i inline Sigma1(__m256i x) { return Xor(RotR(x, 6), RotR(x, 11), RotR(x, 25)); }
+__m256i inline sigma0(__m256i x) { return Xor(RotR(x, 7), RotR(x, 18), ShR(x, 3)); }
+__m256i inline sigma1(__m256i x) { return Xor(RotR(x, 17), RotR(x, 19), ShR(x, 10)); }
+
+/** Run the 64 rounds over one block per lane; w is consumed as the rolling message schedule. */
+void inline Compress(__m256i* s, __m256i* w)
+{
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int i = 0; i < 64; ++i) {
+        if (i >= 16) {
+            w[i & 15] = Add(w[i & 15], sigma1(w[(i + 14) & 15]), w[(i + 9) & 15], sigma0(w[(i + 1) & 15]));
+        }
+        __m256i t1 = Add(h, Sigma1(e), Ch(e, f, g), Add(K32(K[i]), w[i & 15]));
+        __m256i t2 = Add(Sigma0(a), Maj(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = Add(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = Add(t1, t2);
+    }
+    s[0] = Add(s[0], a);
+    s[1] = Add(s[1], b);
+    s[2] = Add(s[2], c);
+    s[3] = Add(s[3], d);
+    s[4] = Add(s[4], e);
+    s[5] = Add(s[5], f);
+    s[6] = Add(s[6], g);
+    s[7] = Add(s[7], h);
+}
+
+/** Gather one big-endian word from each of the 8 lanes' 64-byte inputs. */
+__m256i inline Read8(const unsigned char* in, int offset)
+{
+    return _mm256_set_epi32(ReadBE32(in + 448 + offset), ReadBE32(in + 384 + offset), ReadBE32(in + 320 + offset), ReadBE32(in + 256 + offset),
+                            ReadBE32(in + 192 + offset), ReadBE32(in + 128 + offset), ReadBE32(in + 64 + offset), ReadBE32(in + offset));
+}
+
+/** Scatter one word from each lane into the lanes' 32-byte outputs. */
+void inline Write8(unsigned char* out, int offset, __m256i v)
+{
+    uint32_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, v);
+    for (int i = 0; i < 8; ++i) WriteBE32(out + 32 * i + offset, lanes[i]);
+}
+
+}
+
+/** Compute SHA256(SHA256(in[i*64..i*64+63])) for i in 0..7, writing 8 32-byte results to out. */
+void Transform_8way(unsigned char* out, const unsigned char* in)
+{
+    __m256i s[8], w[16];
+
+    // Transform 1: the 64 input bytes.
+    for (int i = 0; i < 8; ++i) s[i] = K32(INIT[i]);
+    for (int i = 0; i < 16; ++i) w[i] = Read8(in, 4 * i);
+    Compress(s, w);
+
+    // Transform 2: padding for a 64-byte message.
+    w[0] = K32(0x80000000ul);
+    for (int i = 1; i < 15; ++i) w[i] = K32(0);
+    w[15] = K32(0x200);
+    Compress(s, w);
+
+    // Transform 3: hash the 32-byte intermediate digest.
+    for (int i = 0; i < 8; ++i) w[i] = s[i];
+    w[8] = K32(0x80000000ul);
+    for (int i = 9; i < 15; ++i) w[i] = K32(0);
+    w[15] = K32(0x100);
+    for (int i = 0; i < 8; ++i) s[i] = K32(INIT[i]);
+    Compress(s, w);
+
+    for (int i = 0; i < 8; ++i) Write8(out, 4 * i, s[i]);
+}
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// Based on the Intel SHA extensions reference code.
+
+#ifdef ENABLE_SHANI
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+
+namespace {
+
+alignas(16) static const uint32_t K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul};
+
+static const uint32_t INIT[8] = {0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul};
+
+/** Big-endian byte order of each 32-bit word in a 16-byte chunk. */
+alignas(16) static const uint8_t MASK[16] = {0x03, 0x02, 0x01, 0x00, 0x07, 0x06, 0x05, 0x04, 0x0b, 0x0a, 0x09, 0x08, 0x0f, 0x0e, 0x0d, 0x0c};
+
+/** The padding block for a 64-byte message. */
+alignas(16) static const unsigned char PAD64[64] = {0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0x00};
+
+/** Convert an a..h state into the ABEF/CDGH register layout used by sha256rnds2. */
+void inline Unshuffle(const uint32_t* s, __m128i& state0, __m128i& state1)
+{
+    __m128i t1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)s), 0xB1);
+    __m128i t2 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(s + 4)), 0x1B);
+    state0 = _mm_alignr_epi8(t1, t2, 0x08);
+    state1 = _mm_blend_epi16(t2, t1, 0xF0);
+}
+
+/** Inverse of Unshuffle. */
+void inline Shuffle(uint32_t* s, __m128i state0, __m128i state1)
+{
+    __m128i t1 = _mm_shuffle_epi32(state0, 0x1B);
+    __m128i t2 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i*)s, _mm_blend_epi16(t1, t2, 0xF0));
+    _mm_storeu_si128((__m128i*)(s + 4), _mm_alignr_epi8(t2, t1, 0x08));
+}
+
+/** Extend the message schedule for the next group of four words. */
+__m128i inline Schedule(__m128i m0, __m128i m1, __m128i m2, __m128i m3)
+{
+    return _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(m0, m1), _mm_alignr_epi8(m3, m2, 4)), m3);
+}
+
+/** Four rounds; msg already includes the round constants. */
+void inline QuadRound(__m128i& state0, __m128i& state1, __m128i msg)
+{
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+}
+
+__m128i inline Load(const unsigned char* in)
+{
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)in), _mm_load_si128((const __m128i*)MASK));
+}
+
+/** One 64-byte block on one state held in ABEF/CDGH form. */
+void inline Compress(__m128i& state0, __m128i& state1, const unsigned char* chunk)
+{
+    const __m128i save0 = state0, save1 = state1;
+    __m128i m[4];
+    for (int g = 0; g < 16; ++g) {
+        if (g < 4) {
+            m[g] = Load(chunk + 16 * g);
+        } else {
+            m[g & 3] = Schedule(m[g & 3], m[(g + 1) & 3], m[(g + 2) & 3], m[(g + 3) & 3]);
+        }
+        QuadRound(state0, state1, _mm_add_epi32(m[g & 3], _mm_load_si128((const __m128i*)(K + 4 * g))));
+    }
+    state0 = _mm_add_epi32(state0, save0);
+    state1 = _mm_add_epi32(state1, save1);
+}
+
+/** Two independent blocks on two states, interleaved to hide the sha256rnds2 latency. */
+void inline Compress2(__m128i& stateA0, __m128i& stateA1, const unsigned char* chunkA,
+                      __m128i& stateB0, __m128i& stateB1, const unsigned char* chunkB)
+{
+    const __m128i saveA0 = stateA0, saveA1 = stateA1, saveB0 = stateB0, saveB1 = stateB1;
+    __m128i ma[4], mb[4];
+    for (int g = 0; g < 16; ++g) {
+        if (g < 4) {
+            ma[g] = Load(chunkA + 16 * g);
+            mb[g] = Load(chunkB + 16 * g);
+        } else {
+            ma[g & 3] = Schedule(ma[g & 3], ma[(g + 1) & 3], ma[(g + 2) & 3], ma[(g + 3) & 3]);
+            mb[g & 3] = Schedule(mb[g & 3], mb[(g + 1) & 3], mb[(g + 2) & 3], mb[(g + 3) & 3]);
+        }
+        const __m128i k = _mm_load_si128((const __m128i*)(K + 4 * g));
+        QuadRound(stateA0, stateA1, _mm_add_epi32(ma[g & 3], k));
+        QuadRound(stateB0, stateB1, _mm_add_epi32(mb[g & 3], k));
+    }
+    stateA0 = _mm_add_epi32(stateA0, saveA0);
+    stateA1 = _mm_add_epi32(stateA1, saveA1);
+    stateB0 = _mm_add_epi32(stateB0, saveB0);
+    stateB1 = _mm_add_epi32(stateB1, saveB1);
+}
+
+/** Serialize a state as the second block of SHA256 over a 32-byte message. */
+void inline DigestBlock(unsigned char* block, __m128i state0, __m128i state1)
+{
+    uint32_t s[8];
+    Shuffle(s, state0, state1);
+    for (int i = 0; i < 8; ++i) WriteBE32(block + 4 * i, s[i]);
+    memset(block + 32, 0, 32);
+    block[32] = 0x80;
+    block[62] = 0x01;
+}
+
+}
+
+namespace sha256_shani {
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    __m128i state0, state1;
+    Unshuffle(s, state0, state1);
+    while (blocks--) {
+        Compress(state0, state1, chunk);
+        chunk += 64;
+    }
+    Shuffle(s, state0, state1);
+}
+}
+
+namespace sha256d64_shani {
+void Transform_2way(unsigned char* out, const unsigned char* in)
+{
+    __m128i a0, a1, b0, b1;
+    Unshuffle(INIT, a0, a1);
+    b0 = a0;
+    b1 = a1;
+    Compress2(a0, a1, in, b0, b1, in + 64);
+    Compress2(a0, a1, PAD64, b0, b1, PAD64);
+
+    alignas(16) unsigned char blockA[64], blockB[64];
+    DigestBlock(blockA, a0, a1);
+    DigestBlock(blockB, b0, b1);
+    Unshuffle(INIT, a0, a1);
+    b0 = a0;
+    b1 = a1;
+    Compress2(a0, a1, blockA, b0, b1, blockB);
+
+    uint32_t s[8];
+    Shuffle(s, a0, a1);
+    for (int i = 0; i < 8; ++i) WriteBE32(out + 4 * i, s[i]);
+    Shuffle(s, b0, b1);
+    for (int i = 0; i < 8; ++i) WriteBE32(out + 32 + 4 * i, s[i]);
+}
+}
+
+#endif
@@ -475,6 +475,27 @@ public:
             }
         return false;
     }
+
+    /** get is contains that also copies the stored element into e on a hit.
+     *
+     * Useful when Element carries a payload that operator== ignores.
+     *
+     * @param e the element to look up; overwritten with the stored element if found
+     * @param erase
+     * @returns true if the element is found, false otherwise
+     */
+    inline bool get(Element& e, const bool erase) const
+    {
+        std::array<uint32_t, 8> locs = compute_hashes(e);
+        for (uint32_t loc : locs)
+            if (table[loc] == e) {
+                e = table[loc];
+                if (erase)
+                    allow_erase(loc);
+                return true;
+            }
+        return false;
+    }
 };
 } // namespace CuckooCache
 
@@ -22,6 +22,34 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** How much of a request body is scanned for the method name when picking a work queue */
+static const size_t MAX_CLASSIFY_BODY_SIZE = 4096;
+
+/** Methods served by their own HTTP work queue, so that long-polls and slow
+ * contract calls cannot starve transaction submission or each other.
+ * Everything else goes to the default queue.
+ */
+static const std::map<std::string, std::string> mapRPCWorkQueues = {
+    {"waitfornewblock", "longpoll"},
+    {"waitforblock", "longpoll"},
+    {"waitforblockheight", "longpoll"},
+    {"waitforlogs", "longpoll"},
+    {"callcontract", "contract"},
+    {"createcontract", "contract"},
+    {"sendtocontract", "contract"},
+    {"getaccountinfo", "contract"},
+    {"getstorage", "contract"},
+    {"listcontracts", "contract"},
+    {"searchlogs", "contract"},
+    {"gettransactionreceipt", "contract"},
+    {"sendrawtransaction", "tx"},
+    {"signrawtransaction", "tx"},
+    {"sendtoaddress", "tx"},
+    {"sendmany", "tx"},
+    {"sendmanywithdupes", "tx"},
+    {"sendfrom", "tx"},
+};
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -148,6 +176,141 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return multiUserAuthorized(strUserPass);
 }
 
+/** Pick the work queue of a JSON-RPC request. This runs on the event thread,
+ * so instead of parsing the body it only looks for the "method" member of a
+ * single request; batches and anything unexpected use the default queue.
+ */
+static std::string HTTPReq_JSONRPC_Classify(HTTPRequest* req, const std::string &)
+{
+    std::string body = req->PeekBody(MAX_CLASSIFY_BODY_SIZE);
+    size_t pos = body.find_first_not_of(" \t\r\n");
+    if (pos == std::string::npos || body[pos] != '{')
+        return "";
+    pos = body.find("\"method\"", pos);
+    if (pos == std::string::npos)
+        return "";
+    pos = body.find_first_not_of(" \t\r\n", pos + 8);
+    if (pos == std::string::npos || body[pos] != ':')
+        return "";
+    pos = body.find_first_not_of(" \t\r\n", pos + 1);
+    if (pos == std::string::npos || body[pos] != '"')
+        return "";
+    size_t end = body.find('"', pos + 1);
+    if (end == std::string::npos)
+        return "";
+    auto it = mapRPCWorkQueues.find(body.substr(pos + 1, end - pos - 1));
+    return it == mapRPCWorkQueues.end() ? "" : it->second;
+}
+
+/** Sink for a JSONStreamWriter that starts a chunked reply to req once the
+ * writer hands over its first chunk.
+ */
+static JSONStreamWriter::Sink HTTPChunkSink(HTTPRequest* req)
+{
+    return [req](const std::string& chunk) {
+        if (!req->isChunkMode()) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->ChunkStart();
+        }
+        req->Chunk(chunk);
+    };
+}
+
+/** Finish a reply written through HTTPChunkSink, as a plain reply if it never
+ * started chunking.
+ */
+static void HTTPFinishReply(HTTPRequest* req, JSONStreamWriter& writer)
+{
+    if (req->isChunkMode()) {
+        writer.Flush();
+        req->ChunkEnd();
+    } else {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, writer.TakeBuffer());
+    }
+}
+
+/** Serialize the reply to a JSON-RPC request straight into the HTTP reply.
+ * Replies that fit in one chunk are sent as usual, larger ones are streamed
+ * with chunked transfer encoding as they are written. Errors are left to the
+ * caller unless the reply has already started, then it is cut short.
+ */
+static void JSONRPCStreamReply(HTTPRequest* req, const std::function<void(JSONStreamWriter&)>& writeResult, const UniValue& id)
+{
+    JSONStreamWriter writer(HTTPChunkSink(req));
+
+    try {
+        writer.BeginObject();
+        writer.Key("result");
+        writeResult(writer);
+        writer.Key("error");
+        writer.Value(NullUniValue);
+        writer.Key("id");
+        writer.Value(id);
+        writer.EndObject();
+        writer.Raw("\n");
+    } catch (...) {
+        if (!req->isChunkMode())
+            throw;
+        LogPrintf("%s: error while streaming the reply, closing it\n", __func__);
+        req->ChunkEnd();
+        return;
+    }
+
+    HTTPFinishReply(req, writer);
+}
+
+/** Execute a batch of JSON-RPC requests, streaming the replies out in order
+ * as they are done.
+ */
+static void JSONRPCStreamBatchReply(HTTPRequest* req, const JSONRPCRequest& jreq, const UniValue& vReq)
+{
+    JSONStreamWriter writer(HTTPChunkSink(req));
+    JSONRPCExecBatch(jreq, vReq, writer);
+    writer.Raw("\n");
+    HTTPFinishReply(req, writer);
+}
+
+/** Execute a single JSON-RPC request and reply to it. A long-poll method that
+ * has nothing to return yet gets the request parked, and this runs again for
+ * it once the HTTP server resumes the request.
+ */
+static bool HTTPReq_JSONRPC_Execute(HTTPRequest* req, JSONRPCRequest& jreq)
+{
+    try {
+        UniValue result;
+        try {
+            result = tableRPC.execute(jreq);
+        } catch (const RPCStreamResult& stream) {
+            JSONRPCStreamReply(req, stream.write, jreq.id);
+            return true;
+        }
+
+        if (req->isChunkMode()) {
+            jreq.isLongPolling = true;
+            jreq.PollReply(result);
+            return true;
+        }
+
+        JSONRPCStreamReply(req, [&result](JSONStreamWriter& writer) { writer.Value(result); }, jreq.id);
+    } catch (const RPCLongPollPending& pending) {
+        JSONRPCRequest jreqParked(jreq);
+        jreqParked.pollState = pending.state;
+        req->Park(pending.nDeadline, [jreqParked](HTTPRequest* req, const std::string &) mutable {
+            jreqParked.req = req;
+            jreqParked.isLongPolling = req->isChunkMode();
+            return HTTPReq_JSONRPC_Execute(req, jreqParked);
+        });
+    } catch (const UniValue& objError) {
+        JSONErrorReply(req, objError, jreq.id);
+        return false;
+    } catch (const std::exception& e) {
+        JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+        return false;
+    }
+    return true;
+}
+
 static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
 {
     // JSONRPC handles only POST
@@ -186,29 +349,19 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         // Set the URI
         jreq.URI = req->GetURI();
 
-        std::string strReply;
         // singleton request
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
+            jreq.fCanPark = true;
+            jreq.fCanStream = true;
 
-            UniValue result = tableRPC.execute(jreq);
-
-            if (jreq.isLongPolling) {
-                jreq.PollReply(result);
-                return true;
-            }
-
-            // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            return HTTPReq_JSONRPC_Execute(req, jreq);
 
         // array of requests
         } else if (valRequest.isArray())
-            strReply = JSONRPCExecBatch(jreq, valRequest.get_array());
+            JSONRPCStreamBatchReply(req, jreq, valRequest.get_array());
         else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
-
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
         JSONErrorReply(req, objError, jreq.id);
         return false;
@@ -243,10 +396,10 @@ bool StartHTTPRPC()
     if (!InitRPCAuthentication())
         return false;
 
-    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC, HTTPReq_JSONRPC_Classify);
 #ifdef ENABLE_WALLET
     // ifdef can be removed once we switch to better endpoint support and API versioning
-    RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
+    RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC, HTTPReq_JSONRPC_Classify);
 #endif
     assert(EventBase());
     httpRPCTimerInterface = MakeUnique<HTTPRPCTimerInterface>(EventBase());
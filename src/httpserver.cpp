@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 #include <signal.h>
 #include <future>
+#include <list>
 
 #include <event2/thread.h>
 #include <event2/buffer.h>
@@ -41,24 +42,31 @@
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+/** Number of buckets of the work queue depth histogram */
+static const size_t HTTP_DEPTH_HISTOGRAM_BUCKETS = 16;
+
+template <typename WorkItem>
+class WorkQueue;
+
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
 {
 public:
-    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func):
-        req(std::move(_req)), path(_path), func(_func)
+    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func, WorkQueue<HTTPClosure>* _queue):
+        req(std::move(_req)), path(_path), func(_func), queue(_queue)
     {
     }
-    void operator()() override
-    {
-        func(req.get(), path);
-    }
+    void operator()() override;
 
     std::unique_ptr<HTTPRequest> req;
 
 private:
     std::string path;
     HTTPRequestHandler func;
+    //! Queue this item runs on, and goes back to when resumed after parking
+    WorkQueue<HTTPClosure>* queue;
+
+    friend bool ResumeParkedWorkItem(std::unique_ptr<HTTPWorkItem>& item);
 };
 
 /** Simple work queue for distributing work over multiple threads.
@@ -74,10 +82,16 @@ private:
     std::deque<std::unique_ptr<WorkItem>> queue;
     bool running;
     size_t maxDepth;
+    size_t peakDepth;
+    uint64_t rejected;
+    std::vector<uint64_t> depthHistogram;
 
 public:
     explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
+                                 maxDepth(_maxDepth),
+                                 peakDepth(0),
+                                 rejected(0),
+                                 depthHistogram(HTTP_DEPTH_HISTOGRAM_BUCKETS)
     {
     }
     /** Precondition: worker threads have all stopped (they have been joined).
@@ -89,10 +103,19 @@ public:
     bool Enqueue(WorkItem* item)
     {
         std::unique_lock<std::mutex> lock(cs);
+        if (!running) {
+            return false;
+        }
         if (queue.size() >= maxDepth) {
+            rejected++;
             return false;
         }
+        size_t bucket = 0;
+        while (bucket + 1 < depthHistogram.size() && (queue.size() >> bucket) != 0)
+            bucket++;
+        depthHistogram[bucket]++;
         queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        peakDepth = std::max(peakDepth, queue.size());
         cond.notify_one();
         return true;
     }
@@ -120,20 +143,66 @@ public:
         running = false;
         cond.notify_all();
     }
+    /** Fill in the depth counters of stats */
+    void GetStats(HTTPWorkQueueStats& stats)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        stats.nMaxDepth = maxDepth;
+        stats.nDepth = queue.size();
+        stats.nPeakDepth = peakDepth;
+        stats.nRejected = rejected;
+        stats.vDepthHistogram = depthHistogram;
+    }
 };
 
 struct HTTPPathHandler
 {
     HTTPPathHandler() {}
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRequestClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
+};
+
+/** A class of requests with its own work queue and worker threads */
+struct HTTPWorkQueueInfo
+{
+    const char* name;
+    const char* threadsArg;
+    int nDefaultThreads;
+};
+
+static const HTTPWorkQueueInfo httpWorkQueueInfo[] = {
+    {"default", "-rpcthreads", DEFAULT_HTTP_THREADS},
+    {"longpoll", "-rpclongpollthreads", DEFAULT_HTTP_LONGPOLL_THREADS},
+    {"contract", "-rpccontractthreads", DEFAULT_HTTP_CONTRACT_THREADS},
+    {"tx", "-rpctxthreads", DEFAULT_HTTP_TX_THREADS},
+};
+
+static int HTTPWorkQueueThreads(const HTTPWorkQueueInfo& info)
+{
+    return std::max((long)gArgs.GetArg(info.threadsArg, info.nDefaultThreads), 1L);
+}
+
+/** A request set aside by HTTPRequest::Park */
+struct HTTPParkedItem
+{
+    std::unique_ptr<HTTPWorkItem> item;
+    int64_t nDeadline;
+    //! Resume as soon as the work queue has room
+    bool fWake;
+    int64_t nLastPing;
 };
 
+/** Interval of the timer that pings, expires and retries parked requests, in milliseconds */
+static const int HTTP_PARKED_TIMER_INTERVAL = 250;
+/** Interval between keep-alive pings of parked chunked requests, in milliseconds */
+static const int HTTP_PARKED_PING_INTERVAL = 1000;
+
 /** HTTP module state */
 
 //! libevent event loop
@@ -142,13 +211,115 @@ static struct event_base* eventBase = nullptr;
 struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static WorkQueue<HTTPClosure>* workQueue = nullptr;
+//! Work queues for handling longer requests off the event loop thread, by name
+static std::map<std::string, WorkQueue<HTTPClosure>*> workQueues;
+//! Parked requests
+static std::mutex cs_parked;
+static std::list<HTTPParkedItem> parkedItems;
+//! Incremented by every WakeParkedHTTPRequests(), guarded by cs_parked
+static uint64_t nParkedWakeSeq = 0;
+//! Timer serving parkedItems
+static HTTPEvent* parkedTimer = nullptr;
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
 std::vector<evhttp_bound_socket *> boundSockets;
 
+/** Hand a parked item back to its work queue. Takes ownership on success. */
+bool ResumeParkedWorkItem(std::unique_ptr<HTTPWorkItem>& item)
+{
+    if (!item->queue->Enqueue(item.get()))
+        return false;
+    item.release();
+    return true;
+}
+
+void HTTPWorkItem::operator()()
+{
+    uint64_t nWakeSeq;
+    {
+        std::lock_guard<std::mutex> lock(cs_parked);
+        nWakeSeq = nParkedWakeSeq;
+    }
+
+    func(req.get(), path);
+
+    if (!req->IsParked())
+        return;
+    int64_t nDeadline = req->GetParkDeadline();
+    std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(req), path, HTTPRequestHandler(), queue));
+    item->func = item->req->Unpark();
+
+    std::lock_guard<std::mutex> lock(cs_parked);
+    // A wake-up that happened while the handler ran may be the one it parks for
+    bool fWake = nWakeSeq != nParkedWakeSeq;
+    if (fWake && ResumeParkedWorkItem(item))
+        return;
+    parkedItems.push_back(HTTPParkedItem{std::move(item), nDeadline, fWake, GetTimeMillis()});
+}
+
+void WakeParkedHTTPRequests()
+{
+    std::lock_guard<std::mutex> lock(cs_parked);
+    nParkedWakeSeq++;
+    for (auto it = parkedItems.begin(); it != parkedItems.end();) {
+        if (ResumeParkedWorkItem(it->item)) {
+            it = parkedItems.erase(it);
+        } else {
+            it->fWake = true;
+            ++it;
+        }
+    }
+}
+
+size_t GetParkedHTTPRequestCount()
+{
+    std::lock_guard<std::mutex> lock(cs_parked);
+    return parkedItems.size();
+}
+
+/** Runs on the event thread: resumes parked requests that expired, lost
+ * their client or could not be queued before, and pings the others. */
+static void HTTPParkedTimer()
+{
+    int64_t nNow = GetTimeMillis();
+    {
+        std::lock_guard<std::mutex> lock(cs_parked);
+        for (auto it = parkedItems.begin(); it != parkedItems.end();) {
+            HTTPRequest* req = it->item->req.get();
+            if (it->fWake || (it->nDeadline && nNow >= it->nDeadline) || req->isConnClosed()) {
+                if (ResumeParkedWorkItem(it->item)) {
+                    it = parkedItems.erase(it);
+                    continue;
+                }
+                it->fWake = true;
+            } else if (req->isChunkMode() && nNow - it->nLastPing >= HTTP_PARKED_PING_INTERVAL) {
+                req->Chunk(" ");
+                it->nLastPing = nNow;
+            }
+            ++it;
+        }
+    }
+    struct timeval tv = {0, HTTP_PARKED_TIMER_INTERVAL * 1000};
+    parkedTimer->trigger(&tv);
+}
+
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats()
+{
+    std::vector<HTTPWorkQueueStats> vStats;
+    for (const HTTPWorkQueueInfo& info : httpWorkQueueInfo) {
+        auto it = workQueues.find(info.name);
+        if (it == workQueues.end())
+            continue;
+        HTTPWorkQueueStats stats;
+        stats.name = info.name;
+        stats.nThreads = HTTPWorkQueueThreads(info);
+        it->second->GetStats(stats);
+        vStats.push_back(stats);
+    }
+    return vStats;
+}
+
 /** Check if a network address is allowed to access the HTTP server */
 static bool ClientAllowed(const CNetAddr& netaddr)
 {
@@ -258,12 +429,16 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        std::string queueName = i->classifier ? i->classifier(hreq.get(), path) : std::string();
+        auto itQueue = workQueues.find(queueName);
+        if (itQueue == workQueues.end())
+            itQueue = workQueues.find("default");
+        assert(itQueue != workQueues.end());
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler, itQueue->second));
+        if (itQueue->second->Enqueue(item.get()))
             item.release(); /* if true, queue took ownership */
         else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            LogPrintf("WARNING: request rejected because http %s work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n", itQueue->first);
             item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
         }
     } else {
@@ -396,9 +571,11 @@ bool InitHTTPServer()
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    LogPrintf("HTTP: creating work queues of depth %d\n", workQueueDepth);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    for (const HTTPWorkQueueInfo& info : httpWorkQueueInfo) {
+        workQueues[info.name] = new WorkQueue<HTTPClosure>(workQueueDepth);
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -426,14 +603,20 @@ static std::vector<std::thread> g_thread_http_workers;
 bool StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
-    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
+    parkedTimer = new HTTPEvent(eventBase, false, nullptr, HTTPParkedTimer);
+    struct timeval tv = {0, HTTP_PARKED_TIMER_INTERVAL * 1000};
+    parkedTimer->trigger(&tv);
+
     std::packaged_task<bool(event_base*, evhttp*)> task(ThreadHTTP);
     threadResult = task.get_future();
     threadHTTP = std::thread(std::move(task), eventBase, eventHTTP);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
+    for (const HTTPWorkQueueInfo& info : httpWorkQueueInfo) {
+        int rpcThreads = HTTPWorkQueueThreads(info);
+        LogPrintf("HTTP: starting %d %s worker threads\n", rpcThreads, info.name);
+        for (int i = 0; i < rpcThreads; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueues[info.name]);
+        }
     }
     return true;
 }
@@ -449,26 +632,45 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (workQueue)
-        workQueue->Interrupt();
+    for (const auto& queue : workQueues)
+        queue.second->Interrupt();
 }
 
 void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (workQueue) {
+    bool fAnsweredParked = false;
+    if (!workQueues.empty()) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
         for (auto& thread: g_thread_http_workers) {
             thread.join();
         }
         g_thread_http_workers.clear();
-        delete workQueue;
-        workQueue = nullptr;
+        // Answer parked long-polls here; with RPC stopped they return at once
+        std::list<HTTPParkedItem> items;
+        {
+            std::lock_guard<std::mutex> lock(cs_parked);
+            items.swap(parkedItems);
+        }
+        for (HTTPParkedItem& parked : items) {
+            (*parked.item)();
+            fAnsweredParked = true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(cs_parked);
+            parkedItems.clear();
+        }
+        for (const auto& queue : workQueues)
+            delete queue.second;
+        workQueues.clear();
     }
     if (eventBase) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP event thread to exit\n");
-        // Exit the event loop as soon as there are no active events.
-        event_base_loopexit(eventBase, nullptr);
+        // Exit the event loop as soon as there are no active events, or a
+        // moment later if parked requests were just answered, so that their
+        // replies get written out.
+        struct timeval tv = {0, HTTP_PARKED_TIMER_INTERVAL * 1000};
+        event_base_loopexit(eventBase, fAnsweredParked ? &tv : nullptr);
         // Give event loop a few seconds to exit (to send back last RPC responses), then break it
         // Before this was solved with event_base_loopexit, but that didn't work as expected in
         // at least libevent 2.0.21 and always introduced a delay. In libevent
@@ -485,6 +687,8 @@ void StopHTTPServer()
         evhttp_free(eventHTTP);
         eventHTTP = nullptr;
     }
+    delete parkedTimer;
+    parkedTimer = nullptr;
     if (eventBase) {
         event_base_free(eventBase);
         eventBase = nullptr;
@@ -529,7 +733,10 @@ void HTTPEvent::trigger(struct timeval* tv)
 HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
                                                         replySent(false),
                                                         startedChunkTransfer(false),
-                                                        connClosed(false)
+                                                        streamingReply(false),
+                                                        connClosed(false),
+                                                        parked(false),
+                                                        nParkDeadline(0)
 {
 }
 HTTPRequest::~HTTPRequest()
@@ -602,6 +809,22 @@ bool HTTPRequest::isChunkMode() {
     return startedChunkTransfer;
 }
 
+void HTTPRequest::Park(int64_t nDeadline, const HTTPRequestHandler& resume) {
+    assert(!replySent && !parked);
+    parked = true;
+    nParkDeadline = nDeadline;
+    parkResume = resume;
+}
+
+HTTPRequestHandler HTTPRequest::Unpark() {
+    assert(parked);
+    parked = false;
+    nParkDeadline = 0;
+    HTTPRequestHandler resume;
+    resume.swap(parkResume);
+    return resume;
+}
+
 std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string& hdr)
 {
     const struct evkeyvalq* headers = evhttp_request_get_input_headers(req);
@@ -633,6 +856,17 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t nMaxSize)
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    std::string rv(std::min(evbuffer_get_length(buf), nMaxSize), '\0');
+    if (rv.empty() || evbuffer_copyout(buf, &rv[0], rv.size()) < 0)
+        return "";
+    return rv;
+}
+
 bool HTTPRequest::ReplySent() {
     return replySent;
 }
@@ -652,6 +886,14 @@ void HTTPRequest::ChunkEnd() {
 
     ev->trigger(0);
 
+    if (streamingReply) {
+        // No close callback was installed, so evhttp owns the request from here
+        // on like after WriteReply.
+        replySent = true;
+        req = nullptr;
+        return;
+    }
+
     // If HTTPRequest is destroyed before connection is closed, evhttp seems to get messed up.
     // We wait here for connection close before returning back to the handler, where HTTPRequest will be reclaimed.
     waitClientClose();
@@ -662,6 +904,18 @@ void HTTPRequest::ChunkEnd() {
     // req = 0;
 }
 
+void HTTPRequest::ChunkStart() {
+    assert(!replySent && !startedChunkTransfer);
+
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, NULL,
+            std::bind(evhttp_send_reply_start, req, HTTP_OK,
+                    (const char*) NULL));
+    ev->trigger(0);
+
+    startedChunkTransfer = true;
+    streamingReply = true;
+}
+
 void HTTPRequest::Chunk(const std::string& chunk) {
     assert(!replySent);
 
@@ -759,10 +1013,11 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod()
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -8,12 +8,16 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+static const int DEFAULT_HTTP_LONGPOLL_THREADS=2;
+static const int DEFAULT_HTTP_CONTRACT_THREADS=2;
+static const int DEFAULT_HTTP_TX_THREADS=2;
 
 struct evhttp_request;
 struct event_base;
@@ -40,11 +44,18 @@ bool UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Picks the work queue ("default", "longpoll", "contract" or "tx") a request
+ * is dispatched to. Called on the event thread, so it must be cheap.
+ * An empty or unknown name selects the default queue.
+ */
+typedef std::function<std::string(HTTPRequest* req, const std::string &)> HTTPRequestClassifier;
+
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
  * be invoked.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier = HTTPRequestClassifier());
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -53,6 +64,27 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
  */
 struct event_base* EventBase();
 
+/** Resume all parked requests, see HTTPRequest::Park. */
+void WakeParkedHTTPRequests();
+
+/** Counters of one HTTP work queue */
+struct HTTPWorkQueueStats
+{
+    std::string name;
+    int nThreads;
+    size_t nMaxDepth;
+    size_t nDepth;
+    size_t nPeakDepth;
+    uint64_t nRejected;
+    //! Queue depth seen by each enqueued request, bucket i counts depths in [2^(i-1), 2^i)
+    std::vector<uint64_t> vDepthHistogram;
+};
+
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats();
+
+/** Number of requests currently parked */
+size_t GetParkedHTTPRequestCount();
+
 /** In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
  */
@@ -62,7 +94,11 @@ private:
     struct evhttp_request* req;
     bool replySent;
     bool startedChunkTransfer;
+    bool streamingReply;
     bool connClosed;
+    bool parked;
+    int64_t nParkDeadline;
+    HTTPRequestHandler parkResume;
 
     std::mutex cs;
     std::condition_variable closeCv;
@@ -86,6 +122,21 @@ public:
     bool isConnClosed();
     bool isChunkMode();
 
+    /**
+     * Park the request instead of finishing it when the current handler
+     * returns. The server keeps it aside without holding a worker thread and
+     * runs resume on the same work queue after WakeParkedHTTPRequests(), once
+     * nDeadline (GetTimeMillis(), 0 for none) has passed or when the client
+     * disconnects. Chunked requests are pinged while parked.
+     *
+     * @note Only call this from a handler, and do not reply afterwards.
+     */
+    void Park(int64_t nDeadline, const HTTPRequestHandler& resume);
+    bool IsParked() const { return parked; }
+    int64_t GetParkDeadline() const { return nParkDeadline; }
+    /** Take the resume handler and clear the parked state */
+    HTTPRequestHandler Unpark();
+
     /** Get requested URI.
      */
     std::string GetURI();
@@ -112,6 +163,11 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Return up to nMaxSize bytes of the request body without consuming it.
+     */
+    std::string PeekBody(size_t nMaxSize);
+
     /**
      * Write output header.
      *
@@ -129,6 +185,13 @@ public:
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
 
+    /**
+     * Start chunk transfer of a reply that is not a long poll, with status
+     * 200. Chunk() writes it and ChunkEnd() finishes it without waiting for
+     * the client to close the connection.
+     */
+    void ChunkStart();
+
     /**
      * Start chunk transfer. Assume to be 200.
      */
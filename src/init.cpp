@@ -14,6 +14,7 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
+#include <coinstats.h>
 #include <compat/sanity.h>
 #include <consensus/validation.h>
 #include <fs.h>
@@ -34,6 +35,7 @@
 #include <rpc/blockchain.h>
 #include <script/standard.h>
 #include <script/sigcache.h>
+#include <abp/ecrecovercache.h>
 #include <scheduler.h>
 #include <timedata.h>
 #include <txdb.h>
@@ -247,6 +249,7 @@ void Shutdown()
         pcoinsTip.reset();
         pcoinscatcher.reset();
         pcoinsdbview.reset();
+        pcoinstatsindex.reset();
         pblocktree.reset();
         pstorageresult.reset();
         globalState.reset();
@@ -378,6 +381,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-sysperms", _("Create new files with system default permissions, instead of umask 077 (only effective with disabled wallet functionality)"));
 #endif
     strUsage += HelpMessageOpt("-txindex", strprintf(_("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)"), DEFAULT_TXINDEX));
+    strUsage += HelpMessageOpt("-coinstatsindex", strprintf(_("Maintain statistics of the UTXO set after every block, used by the gettxoutsetinfo rpc call (default: %u)"), DEFAULT_COINSTATSINDEX));
     strUsage += HelpMessageOpt("-logevents", strprintf(_("Maintain a full EVM log index, used by searchlogs and gettransactionreceipt rpc calls (default: %u)"), DEFAULT_LOGEVENTS));
 
     strUsage += HelpMessageGroup(_("Connection options:"));
@@ -432,6 +436,10 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-zmqpubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawblock=<address>", _("Enable publish raw block in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubreceipt=<address>", _("Enable publish contract transaction receipts in <address> (requires -logevents)"));
+    strUsage += HelpMessageOpt("-zmqpubcontractlog=<address>", _("Enable publish contract log entries in <address> (requires -logevents)"));
+    strUsage += HelpMessageOpt("-zmqcontractaddress=<hex>", _("Only publish receipts and logs involving this contract address (can be specified multiple times)"));
+    strUsage += HelpMessageOpt("-zmqcontracttopic=<hex>", _("Only publish logs carrying this topic (can be specified multiple times)"));
 #endif
 
     strUsage += HelpMessageGroup(_("Debugging/Testing options:"));
@@ -468,6 +476,7 @@ std::string HelpMessage(HelpMessageMode mode)
         strUsage += HelpMessageOpt("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS));
         strUsage += HelpMessageOpt("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)");
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit sum of signature cache and script execution cache sizes to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-ecrecovercachesize=<n>", strprintf("Limit the ecrecover precompile result cache to <n> MiB (default: %u)", DEFAULT_MAX_ECRECOVER_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     }
     strUsage += HelpMessageOpt("-minmempoolgaslimit=<limit>", strprintf("The minimum transaction gas limit we are willing to accept into the mempool (default: %s)",MEMPOOL_MIN_GAS_LIMIT));
@@ -505,6 +514,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-staker-min-tx-gas-price=<amt>", _("Any contract execution with a gas price below this will not be included in a block (defaults to the value specified by the DGP)"));
     strUsage += HelpMessageOpt("-staker-max-tx-gas-limit=<n>", _("Any contract execution with a gas limit over this amount will not be included in a block (defaults to soft block gas limit)"));
     strUsage += HelpMessageOpt("-staker-soft-block-gas-limit=<n>", _("After this amount of gas is surpassed in a block, no more contract executions will be added to the block (defaults to consensus-critical maximum block gas limit)"));
+    strUsage += HelpMessageOpt("-mempoolpreexec", strprintf(_("Dry-run contract transactions in the background when they enter the memory pool, so block creation can skip failing ones and pack by used gas (default: %u)"), DEFAULT_MEMPOOL_PREEXEC));
 
     if (showDebug)
         strUsage += HelpMessageOpt("-blockversion=<n>", "Override block version to test forking scenarios");
@@ -521,8 +531,13 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-rpcallowip=<ip>", _("Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times"));
     strUsage += HelpMessageOpt("-rpcserialversion", strprintf(_("Sets the serialization of raw transaction or block hex returned in non-verbose mode, non-segwit(0) or segwit(1) (default: %d)"), DEFAULT_RPC_SERIALIZE_VERSION));
     strUsage += HelpMessageOpt("-rpcthreads=<n>", strprintf(_("Set the number of threads to service RPC calls (default: %d)"), DEFAULT_HTTP_THREADS));
+    strUsage += HelpMessageOpt("-rpclongpollthreads=<n>", strprintf(_("Set the number of threads to service long-polling RPC calls such as waitforlogs (default: %d)"), DEFAULT_HTTP_LONGPOLL_THREADS));
+    strUsage += HelpMessageOpt("-rpccontractthreads=<n>", strprintf(_("Set the number of threads to service contract RPC calls such as callcontract (default: %d)"), DEFAULT_HTTP_CONTRACT_THREADS));
+    strUsage += HelpMessageOpt("-rpctxthreads=<n>", strprintf(_("Set the number of threads to service transaction submitting RPC calls such as sendrawtransaction (default: %d)"), DEFAULT_HTTP_TX_THREADS));
+    strUsage += HelpMessageOpt("-rpcbatchthreads=<n>", strprintf(_("Set the number of threads running the read-only requests of JSON-RPC batches, such as getblock, 0 to run batches in order on one thread (default: %d)"), DEFAULT_RPC_BATCH_THREADS));
+    strUsage += HelpMessageOpt("-rpcbatchparallel=<n>", strprintf(_("Set the maximum number of requests of one JSON-RPC batch running at the same time (default: %d)"), DEFAULT_RPC_BATCH_PARALLEL));
     if (showDebug) {
-        strUsage += HelpMessageOpt("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE));
+        strUsage += HelpMessageOpt("-rpcworkqueue=<n>", strprintf("Set the depth of each of the work queues to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE));
         strUsage += HelpMessageOpt("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT));
     }
 
@@ -922,8 +937,14 @@ bool AppInitParameterInteraction()
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        if (gArgs.GetBoolArg("-coinstatsindex", DEFAULT_COINSTATSINDEX))
+            return InitError(_("Prune mode is incompatible with -coinstatsindex."));
     }
 
+    // contract receipts are only collected with the log events index
+    if ((gArgs.IsArgSet("-zmqpubreceipt") || gArgs.IsArgSet("-zmqpubcontractlog")) && !gArgs.GetBoolArg("-logevents", DEFAULT_LOGEVENTS))
+        return InitError(_("-zmqpubreceipt and -zmqpubcontractlog require -logevents."));
+
     // -bind and -whitebind can't be set when not listening
     size_t nUserBind = gArgs.GetArgs("-bind").size() + gArgs.GetArgs("-whitebind").size();
     if (nUserBind != 0 && !gArgs.GetBoolArg("-listen", DEFAULT_LISTEN)) {
@@ -1126,6 +1147,8 @@ bool AppInitParameterInteraction()
 
     nMaxTipAge = gArgs.GetArg("-maxtipage", DEFAULT_MAX_TIP_AGE);
 
+    fMempoolPreExecute = gArgs.GetBoolArg("-mempoolpreexec", DEFAULT_MEMPOOL_PREEXEC);
+
     fEnableReplacement = gArgs.GetBoolArg("-mempoolreplacement", DEFAULT_ENABLE_REPLACEMENT);
     if ((!fEnableReplacement) && gArgs.IsArgSet("-mempoolreplacement")) {
         // Minimal effort at forwards compatibility
@@ -1256,11 +1279,14 @@ bool AppInitMain()
 
     InitSignatureCache();
     InitScriptExecutionCache();
+    InitEcrecoverCache();
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
-        for (int i=0; i<nScriptCheckThreads-1; i++)
+        for (int i=0; i<nScriptCheckThreads-1; i++) {
             threadGroup.create_thread(&ThreadScriptCheck);
+            threadGroup.create_thread(&ThreadCoinsPrefetch);
+        }
     }
 
     // Start the lightweight task scheduler thread
@@ -1672,6 +1698,19 @@ bool AppInitMain()
         LogPrintf(" block index %15dms\n", GetTimeMillis() - nStart);
     }
 
+    // The coin statistics index catches up with the chain loaded above, if it
+    // was not running for some of it, before any block gets connected
+    if (gArgs.GetBoolArg("-coinstatsindex", DEFAULT_COINSTATSINDEX)) {
+        pcoinstatsindex.reset(new CCoinStatsIndex(nCoinStatsIndexCache << 20, false, fReindex || fReindexChainState));
+        if (!SyncCoinStatsIndex(chainparams)) {
+            return InitError(_("Unable to build the coin statistics index."));
+        }
+        if (fRequestShutdown) {
+            LogPrintf("Shutdown requested. Exiting.\n");
+            return false;
+        }
+    }
+
     fs::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
     CAutoFile est_filein(fsbridge::fopen(est_path, "rb"), SER_DISK, CLIENT_VERSION);
     // Allowed to fail as this file IS missing on first startup.
@@ -1732,6 +1771,9 @@ bool AppInitMain()
 
     threadGroup.create_thread(boost::bind(&ThreadImport, vImportFiles));
 
+    if (fMempoolPreExecute)
+        threadGroup.create_thread(&ThreadContractPreExecution);
+
     // Wait for genesis block to be processed
     {
         WaitableLock lock(cs_GenesisWait);
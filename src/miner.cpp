@@ -23,6 +23,7 @@
 #include <primitives/transaction.h>
 #include <script/standard.h>
 #include <timedata.h>
+#include <abp/ecrecovercache.h>
 #include <util.h>
 #include <utilmoneystr.h>
 #include <validationinterface.h>
@@ -224,17 +225,18 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     }
 
     //////////////////////////////////////////////////////// abp
-    AbpDGP abpDGP(globalState.get(), fGettingValuesDGP);
-    globalSealEngine->setAbpSchedule(abpDGP.getGasSchedule(nHeight));
-    uint32_t blockSizeDGP = abpDGP.getBlockSize(nHeight);
-    minGasPrice = abpDGP.getMinGasPrice(nHeight);
+    DGPParams dgpParams = GetEVMTipContext()->GetDGPParams(nHeight);
+    globalSealEngine->setAbpSchedule(dgpParams.schedule);
+    UpdateEcrecoverCacheSchedule(globalSealEngine->getAbpSchedule());
+    uint32_t blockSizeDGP = dgpParams.blockSize;
+    minGasPrice = dgpParams.minGasPrice;
     if(gArgs.IsArgSet("-staker-min-tx-gas-price")) {
         CAmount stakerMinGasPrice;
         if(ParseMoney(gArgs.GetArg("-staker-min-tx-gas-price", ""), stakerMinGasPrice)) {
             minGasPrice = std::max(minGasPrice, (uint64_t)stakerMinGasPrice);
         }
     }
-    hardBlockGasLimit = abpDGP.getBlockGasLimit(nHeight);
+    hardBlockGasLimit = dgpParams.blockGasLimit;
     softBlockGasLimit = gArgs.GetArg("-staker-soft-block-gas-limit", hardBlockGasLimit);
     softBlockGasLimit = std::min(softBlockGasLimit, hardBlockGasLimit);
     txGasLimit = gArgs.GetArg("-staker-max-tx-gas-limit", softBlockGasLimit);
@@ -259,7 +261,7 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     pblocktemplate->vchCoinbaseCommitment = GenerateCoinbaseCommitment(*pblock, pindexPrev, chainparams.GetConsensus(), fProofOfStake);
     pblocktemplate->vTxFees[0] = -nFees;
 
-    LogPrintf("CreateNewBlock(): block weight: %u txs: %u fees: %ld sigops %d\n", GetBlockWeight(*pblock), nBlockTx, nFees, nBlockSigOpsCost);
+    LogPrintf("CreateNewBlock(): block weight: %u txs: %u fees: %ld sigops %d gas: %u/%u\n", GetBlockWeight(*pblock), nBlockTx, nFees, nBlockSigOpsCost, bceResult.usedGas, softBlockGasLimit);
 
     // The total fee is the Fees minus the Refund
     if (pTotalFees)
@@ -409,16 +411,29 @@ void BlockAssembler::onlyUnconfirmed(CTxMemPool::setEntries& testSet)
     }
 }
 
-bool BlockAssembler::TestPackage(uint64_t packageSize, int64_t packageSigOpsCost) const
+bool BlockAssembler::TestPackage(uint64_t packageSize, int64_t packageSigOpsCost, uint64_t packageGas) const
 {
     // TODO: switch to weight-based accounting for packages instead of vsize-based accounting.
     if (nBlockWeight + WITNESS_SCALE_FACTOR * packageSize >= nBlockMaxWeight)
         return false;
     if (nBlockSigOpsCost + packageSigOpsCost >= (uint64_t)dgpMaxBlockSigOps)
         return false;
+    if (packageGas > 0) {
+        if (IsBlockGasFull())
+            return false;
+        // Without dry-run results the contract outputs are budgeted by their gas limits,
+        // so don't execute a package that can not fit in the remaining gas
+        if (!fMempoolPreExecute && bceResult.usedGas + packageGas > softBlockGasLimit)
+            return false;
+    }
     return true;
 }
 
+bool BlockAssembler::IsBlockGasFull() const
+{
+    return bceResult.usedGas + MINIMUM_GAS_LIMIT > softBlockGasLimit;
+}
+
 // Perform transaction-level checks before adding to block:
 // - transaction finality (locktime)
 // - premature witness (in case segwit transactions are added to mempool before
@@ -442,7 +457,18 @@ bool BlockAssembler::AttemptToAddContractToBlock(CTxMemPool::txiter iter, uint64
     {
         return false;
     }
-    
+
+    // If the mempool already dry-ran this tx against our tip, skip it when it is known to be
+    // rejected and budget the block by the gas it actually used instead of its gas limit
+    const ContractPreExecution& preExec = iter->GetPreExecution();
+    bool fHavePreExec = !preExec.IsNull() && preExec.hashTip == chainActive.Tip()->GetBlockHash();
+    if(fHavePreExec && !preExec.fProcessed){
+        return false;
+    }
+    if(fHavePreExec && bceResult.usedGas + preExec.nUsedGas > softBlockGasLimit){
+        return false;
+    }
+
     dev::h256 oldHashStateRoot(globalState->rootHash());
     dev::h256 oldHashUTXORoot(globalState->rootHashUTXO());
     // operate on local vars first, then later apply to `this`
@@ -466,7 +492,7 @@ bool BlockAssembler::AttemptToAddContractToBlock(CTxMemPool::txiter iter, uint64
             return false;
         }
 
-        if(bceResult.usedGas + abpTransaction.gas() > softBlockGasLimit){
+        if(!fHavePreExec && bceResult.usedGas + abpTransaction.gas() > softBlockGasLimit){
             //if this transaction's gasLimit could cause block gas limit to be exceeded, then don't add it
             return false;
         }
@@ -606,6 +632,7 @@ int BlockAssembler::UpdatePackagesForAdded(const CTxMemPool::setEntries& already
                 modEntry.nSizeWithAncestors -= it->GetTxSize();
                 modEntry.nModFeesWithAncestors -= it->GetModifiedFee();
                 modEntry.nSigOpCostWithAncestors -= it->GetSigOpCost();
+                modEntry.nGasWithAncestors -= it->GetGasLimit();
                 mapModifiedTx.insert(modEntry);
             } else {
                 mapModifiedTx.modify(mit, update_for_parent_inclusion(it));
@@ -642,7 +669,10 @@ void BlockAssembler::SortForBlock(const CTxMemPool::setEntries& package, CTxMemP
 }
 
 // This transaction selection algorithm orders the mempool based
-// on feerate of a transaction including all unconfirmed ancestors.
+// on the fee of a transaction including all unconfirmed ancestors per
+// unit of combined size and gas resource (see MINING_GAS_PER_VBYTE).
+// The score index is maintained by the mempool itself as entries come
+// and go, so only packages touched by this block are re-scored here.
 // Since we don't remove transactions from the mempool as we select them
 // for block inclusion, we need an alternate method of updating the feerate
 // of a transaction with its not-yet-selected ancestors as we go.
@@ -663,7 +693,7 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     // and modifying them for their already included ancestors
     UpdatePackagesForAdded(inBlock, mapModifiedTx);
 
-    CTxMemPool::indexed_transaction_set::index<ancestor_score_or_gas_price>::type::iterator mi = mempool.mapTx.get<ancestor_score_or_gas_price>().begin();
+    CTxMemPool::indexed_transaction_set::index<ancestor_resource_score>::type::iterator mi = mempool.mapTx.get<ancestor_resource_score>().begin();
     CTxMemPool::txiter iter;
 
     // Limit the number of attempts to add transactions to the block when it is
@@ -672,14 +702,14 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     const int64_t MAX_CONSECUTIVE_FAILURES = 1000;
     int64_t nConsecutiveFailed = 0;
 
-    while (mi != mempool.mapTx.get<ancestor_score_or_gas_price>().end() || !mapModifiedTx.empty())
+    while (mi != mempool.mapTx.get<ancestor_resource_score>().end() || !mapModifiedTx.empty())
     {
         if(nTimeLimit != 0 && GetAdjustedTime() >= nTimeLimit){
             //no more time to add transactions, just exit
             return;
         }
         // First try to find a new transaction in mapTx to evaluate.
-        if (mi != mempool.mapTx.get<ancestor_score_or_gas_price>().end() &&
+        if (mi != mempool.mapTx.get<ancestor_resource_score>().end() &&
                 SkipMapTxEntry(mempool.mapTx.project<0>(mi), mapModifiedTx, failedTx)) {
             ++mi;
             continue;
@@ -689,15 +719,15 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
         // the next entry from mapTx, or the best from mapModifiedTx?
         bool fUsingModified = false;
 
-        modtxscoreiter modit = mapModifiedTx.get<ancestor_score_or_gas_price>().begin();
-        if (mi == mempool.mapTx.get<ancestor_score_or_gas_price>().end()) {
+        modtxscoreiter modit = mapModifiedTx.get<ancestor_resource_score>().begin();
+        if (mi == mempool.mapTx.get<ancestor_resource_score>().end()) {
             // We're out of entries in mapTx; use the entry from mapModifiedTx
             iter = modit->iter;
             fUsingModified = true;
         } else {
             // Try to compare the mapTx entry to the mapModifiedTx entry
             iter = mempool.mapTx.project<0>(mi);
-            if (modit != mapModifiedTx.get<ancestor_score_or_gas_price>().end() &&
+            if (modit != mapModifiedTx.get<ancestor_resource_score>().end() &&
                     CompareModifiedEntry()(*modit, CTxMemPoolModifiedEntry(iter))) {
                 // The best entry in mapModifiedTx has higher score
                 // than the one from mapTx.
@@ -718,23 +748,33 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
         uint64_t packageSize = iter->GetSizeWithAncestors();
         CAmount packageFees = iter->GetModFeesWithAncestors();
         int64_t packageSigOpsCost = iter->GetSigOpCostWithAncestors();
+        uint64_t packageGas = iter->GetGasWithAncestors();
         if (fUsingModified) {
             packageSize = modit->nSizeWithAncestors;
             packageFees = modit->nModFeesWithAncestors;
             packageSigOpsCost = modit->nSigOpCostWithAncestors;
+            packageGas = modit->nGasWithAncestors;
         }
 
         if (packageFees < blockMinFeeRate.GetFee(packageSize)) {
-            // Everything else we might consider has a lower fee rate
-            return;
+            // Everything else we might consider has a lower score, so only
+            // packages paying for gas can still meet the fee rate on their size
+            if (IsBlockGasFull() || ++nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES) {
+                return;
+            }
+            if (fUsingModified) {
+                mapModifiedTx.get<ancestor_resource_score>().erase(modit);
+                failedTx.insert(iter);
+            }
+            continue;
         }
 
-        if (!TestPackage(packageSize, packageSigOpsCost)) {
+        if (!TestPackage(packageSize, packageSigOpsCost, packageGas)) {
             if (fUsingModified) {
                 // Since we always look at the best entry in mapModifiedTx,
                 // we must erase failed entries so that we can consider the
                 // next best entry on the next loop iteration
-                mapModifiedTx.get<ancestor_score_or_gas_price>().erase(modit);
+                mapModifiedTx.get<ancestor_resource_score>().erase(modit);
                 failedTx.insert(iter);
             }
 
@@ -759,7 +799,7 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
         // Test if all tx's are Final
         if (!TestPackageTransactions(ancestors)) {
             if (fUsingModified) {
-                mapModifiedTx.get<ancestor_score_or_gas_price>().erase(modit);
+                mapModifiedTx.get<ancestor_resource_score>().erase(modit);
                 failedTx.insert(iter);
             }
             continue;
@@ -788,7 +828,7 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
                     if(!wasAdded){
                         if(fUsingModified) {
                             //this only needs to be done once to mark the whole package (everything in sortedEntries) as failed
-                            mapModifiedTx.get<ancestor_score_or_gas_price>().erase(modit);
+                            mapModifiedTx.get<ancestor_resource_score>().erase(modit);
                             failedTx.insert(iter);
                         }
                     }
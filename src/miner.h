@@ -65,18 +65,22 @@ struct CTxMemPoolModifiedEntry {
         nSizeWithAncestors = entry->GetSizeWithAncestors();
         nModFeesWithAncestors = entry->GetModFeesWithAncestors();
         nSigOpCostWithAncestors = entry->GetSigOpCostWithAncestors();
+        nGasWithAncestors = entry->GetGasWithAncestors();
     }
 
     int64_t GetModifiedFee() const { return iter->GetModifiedFee(); }
     uint64_t GetSizeWithAncestors() const { return nSizeWithAncestors; }
     CAmount GetModFeesWithAncestors() const { return nModFeesWithAncestors; }
+    uint64_t GetGasWithAncestors() const { return nGasWithAncestors; }
     size_t GetTxSize() const { return iter->GetTxSize(); }
+    uint64_t GetGasLimit() const { return iter->GetGasLimit(); }
     const CTransaction& GetTx() const { return iter->GetTx(); }
 
     CTxMemPool::txiter iter;
     uint64_t nSizeWithAncestors;
     CAmount nModFeesWithAncestors;
     int64_t nSigOpCostWithAncestors;
+    uint64_t nGasWithAncestors;
 };
 
 /** Comparator for CTxMemPool::txiter objects.
@@ -99,58 +103,9 @@ struct modifiedentry_iter {
     }
 };
 
-// This related to the calculation in CompareTxMemPoolEntryByAncestorFeeOrGasPrice,
+// This matches the calculation in CompareTxMemPoolEntryByAncestorResourceScore,
 // except operating on CTxMemPoolModifiedEntry.
-// TODO: refactor to avoid duplication of this logic.
-struct CompareModifiedEntry {
-    bool operator()(const CTxMemPoolModifiedEntry &a, const CTxMemPoolModifiedEntry &b) const
-    {
-        bool fAHasCreateOrCall = a.iter->GetTx().HasCreateOrCall();
-        bool fBHasCreateOrCall = b.iter->GetTx().HasCreateOrCall();
-
-        // If either of the two entries that we are comparing has a contract scriptPubKey, the comparison here takes precedence
-        if(fAHasCreateOrCall || fBHasCreateOrCall) {
-
-            // Prioritze non-contract txs
-            if(fAHasCreateOrCall != fBHasCreateOrCall) {
-                return fAHasCreateOrCall ? false : true;
-            }
-
-            // Prioritize the contract txs that have the least number of ancestors
-            // The reason for this is that otherwise it is possible to send one tx with a
-            // high gas limit but a low gas price which has a child with a low gas limit but a high gas price
-            // Without this condition that transaction chain would get priority in being included into the block.
-            // The two next checks are to see if all our ancestors have been added.
-            if(a.nSizeWithAncestors == a.iter->GetTxSize() && b.nSizeWithAncestors != b.iter->GetTxSize()) {
-                return true;
-            }
-
-            if(b.nSizeWithAncestors == b.iter->GetTxSize() && a.nSizeWithAncestors != a.iter->GetTxSize()) {
-                return false;
-            }
-
-            // Otherwise, prioritize the contract tx with the highest (minimum among its outputs) gas price
-            // The reason for using the gas price of the output that sets the minimum gas price is that
-            // otherwise it may be possible to game the prioritization by setting a large gas price in one output
-            // that does no execution, while the real execution has a very low gas price
-            if(a.iter->GetMinGasPrice() != b.iter->GetMinGasPrice()) {
-                return a.iter->GetMinGasPrice() > b.iter->GetMinGasPrice();
-            }
-
-            // Otherwise, prioritize the tx with the min size
-            if(a.iter->GetTxSize() != b.iter->GetTxSize()) {
-                return a.iter->GetTxSize() < b.iter->GetTxSize();
-            }
-
-            // If the txs are identical in their minimum gas prices and tx size
-            // order based on the tx hash for consistency.
-            return CTxMemPool::CompareIteratorByHash()(a.iter, b.iter);
-        }
-
-        // If neither of the txs we are comparing are contract txs, use the standard comparison based on ancestor fees / ancestor size
-        return CompareTxMemPoolEntryByAncestorFee()(a, b);
-    }
-};
+typedef CompareTxMemPoolEntryByAncestorResourceScore CompareModifiedEntry;
 
 // A comparator that sorts transactions based on number of ancestors.
 // This is sufficient to sort an ancestor package in an order that is valid
@@ -171,10 +126,10 @@ typedef boost::multi_index_container<
             modifiedentry_iter,
             CompareCTxMemPoolIter
         >,
-        // sorted by modified ancestor fee rate or gas price
+        // sorted by modified ancestor fee per combined size and gas resource
         boost::multi_index::ordered_non_unique<
             // Reuse same tag from CTxMemPool's similar index
-            boost::multi_index::tag<ancestor_score_or_gas_price>,
+            boost::multi_index::tag<ancestor_resource_score>,
             boost::multi_index::identity<CTxMemPoolModifiedEntry>,
             CompareModifiedEntry
         >
@@ -182,7 +137,7 @@ typedef boost::multi_index_container<
 > indexed_modified_transaction_set;
 
 typedef indexed_modified_transaction_set::nth_index<0>::type::iterator modtxiter;
-typedef indexed_modified_transaction_set::index<ancestor_score_or_gas_price>::type::iterator modtxscoreiter;
+typedef indexed_modified_transaction_set::index<ancestor_resource_score>::type::iterator modtxscoreiter;
 
 struct update_for_parent_inclusion
 {
@@ -193,6 +148,7 @@ struct update_for_parent_inclusion
         e.nModFeesWithAncestors -= iter->GetFee();
         e.nSizeWithAncestors -= iter->GetTxSize();
         e.nSigOpCostWithAncestors -= iter->GetSigOpCost();
+        e.nGasWithAncestors -= iter->GetGasLimit();
     }
 
     CTxMemPool::txiter iter;
@@ -272,7 +228,9 @@ private:
     /** Remove confirmed (inBlock) entries from given set */
     void onlyUnconfirmed(CTxMemPool::setEntries& testSet);
     /** Test if a new package would "fit" in the block */
-    bool TestPackage(uint64_t packageSize, int64_t packageSigOpsCost) const;
+    bool TestPackage(uint64_t packageSize, int64_t packageSigOpsCost, uint64_t packageGas) const;
+    /** Whether the block has no gas left for another contract execution */
+    bool IsBlockGasFull() const;
     /** Perform checks on each transaction in a package:
       * locktime, premature-witness, serialized size (if necessary)
       * These checks should always succeed, and they're here
@@ -21,6 +21,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <rawblock.h>
 #include <reverse_iterator.h>
 #include <scheduler.h>
 #include <tinyformat.h>
@@ -1052,6 +1053,25 @@ static void RelayAddress(const CAddress& addr, bool fReachable, CConnman* connma
     connman->ForEachNodeThen(std::move(sortfunc), std::move(pushfunc));
 }
 
+/**
+ * Send a block as it is stored in its block file, without deserializing it.
+ * Stored blocks include their witnesses, so peers that did not ask for those
+ * can only be served this way when the block has none.
+ */
+static bool SendRawBlockFromDisk(CNode* pfrom, CConnman* connman, const CBlockIndex* pindex, bool fWitness)
+{
+    CBlockView view;
+    if (!ReadRawBlockFromDisk(view, pindex, Params().MessageStart()))
+        return false;
+    if (!fWitness && view.HasWitness())
+        return false;
+    CSerializedNetMsg msg;
+    msg.command = NetMsgType::BLOCK;
+    msg.data.assign(view.GetRawBlock().begin(), view.GetRawBlock().end());
+    connman->PushMessage(pfrom, std::move(msg));
+    return true;
+}
+
 void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensusParams, const CInv& inv, CConnman* connman, const std::atomic<bool>& interruptMsgProc)
 {
     bool send = false;
@@ -1123,6 +1143,8 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
         std::shared_ptr<const CBlock> pblock;
         if (a_recent_block && a_recent_block->GetHash() == (*mi).second->GetBlockHash()) {
             pblock = a_recent_block;
+        } else if ((inv.type == MSG_BLOCK || inv.type == MSG_WITNESS_BLOCK) && SendRawBlockFromDisk(pfrom, connman, (*mi).second, inv.type == MSG_WITNESS_BLOCK)) {
+            // Sent straight from the block file
         } else {
             // Send block from disk
             std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
@@ -1130,7 +1152,9 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
                 assert(!"cannot load block from disk");
             pblock = pblockRead;
         }
-        if (inv.type == MSG_BLOCK)
+        if (!pblock) {
+            // Already sent as stored
+        } else if (inv.type == MSG_BLOCK)
             connman->PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, *pblock));
         else if (inv.type == MSG_WITNESS_BLOCK)
             connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
@@ -3154,9 +3178,9 @@ void PeerLogicValidation::CheckForStaleTipAndEvictPeers(const Consensus::Params
 
 class CompareInvMempoolOrder
 {
-    CTxMemPool *mp;
+    const CTxMemPoolSnapshot *mp;
 public:
-    explicit CompareInvMempoolOrder(CTxMemPool *_mempool)
+    explicit CompareInvMempoolOrder(const CTxMemPoolSnapshot *_mempool)
     {
         mp = _mempool;
     }
@@ -3459,9 +3483,15 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
                 if (!pto->fRelayTxes) pto->setInventoryTxToSend.clear();
             }
 
+            // Read the mempool through a snapshot, so relay doesn't contend
+            // with transaction acceptance for mempool.cs
+            CTxMemPoolSnapshotRef mempoolSnapshot;
+            if (fSendTrickle) {
+                mempoolSnapshot = mempool.GetSnapshot();
+            }
+
             // Respond to BIP35 mempool requests
             if (fSendTrickle && pto->fSendMempool) {
-                auto vtxinfo = mempool.infoAll();
                 pto->fSendMempool = false;
                 CAmount filterrate = 0;
                 {
@@ -3471,16 +3501,16 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
 
                 LOCK(pto->cs_filter);
 
-                for (const auto& txinfo : vtxinfo) {
-                    const uint256& hash = txinfo.tx->GetHash();
+                for (const CTxMemPoolSnapshotEntryRef& entry : mempoolSnapshot->vEntries) {
+                    const uint256& hash = entry->tx->GetHash();
                     CInv inv(MSG_TX, hash);
                     pto->setInventoryTxToSend.erase(hash);
                     if (filterrate) {
-                        if (txinfo.feeRate.GetFeePerK() < filterrate)
+                        if (entry->GetFeeRate().GetFeePerK() < filterrate)
                             continue;
                     }
                     if (pto->pfilter) {
-                        if (!pto->pfilter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        if (!pto->pfilter->IsRelevantAndUpdate(*entry->tx)) continue;
                     }
                     pto->filterInventoryKnown.insert(hash);
                     vInv.push_back(inv);
@@ -3507,7 +3537,7 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
                 }
                 // Topologically and fee-rate sort the inventory we send for privacy and priority reasons.
                 // A heap is used so that not all items need sorting if only a few are being sent.
-                CompareInvMempoolOrder compareInvMempoolOrder(&mempool);
+                CompareInvMempoolOrder compareInvMempoolOrder(mempoolSnapshot.get());
                 std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
                 // No reason to drain out at many times the network's capacity,
                 // especially since we have many peers and some will draw much shorter delays.
@@ -3526,14 +3556,14 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
                         continue;
                     }
                     // Not in the mempool anymore? don't bother sending it.
-                    auto txinfo = mempool.info(hash);
-                    if (!txinfo.tx) {
+                    const CTxMemPoolSnapshotEntry* entry = mempoolSnapshot->find(hash);
+                    if (entry == nullptr) {
                         continue;
                     }
-                    if (filterrate && txinfo.feeRate.GetFeePerK() < filterrate) {
+                    if (filterrate && entry->GetFeeRate().GetFeePerK() < filterrate) {
                         continue;
                     }
-                    if (pto->pfilter && !pto->pfilter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                    if (pto->pfilter && !pto->pfilter->IsRelevantAndUpdate(*entry->tx)) continue;
                     // Send
                     vInv.push_back(CInv(MSG_TX, hash));
                     nRelayedTransactions++;
@@ -3545,7 +3575,7 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
                             vRelayExpiration.pop_front();
                         }
 
-                        auto ret = mapRelay.insert(std::make_pair(hash, std::move(txinfo.tx)));
+                        auto ret = mapRelay.insert(std::make_pair(hash, entry->tx));
                         if (ret.second) {
                             vRelayExpiration.push_back(std::make_pair(nNow + 15 * 60 * 1000000, ret.first));
                         }
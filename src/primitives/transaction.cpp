@@ -75,10 +75,31 @@ uint256 CTransaction::GetWitnessHash() const
     return SerializeHash(*this, SER_GETHASH, 0);
 }
 
+///////////////////////////////////////////////////////////// abp
+static bool OutputsHaveCreateOrCall(const std::vector<CTxOut>& vout){
+    for(const CTxOut& v : vout){
+        if(v.scriptPubKey.HasOpCreate() || v.scriptPubKey.HasOpCall()){
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool InputsHaveOpSpend(const std::vector<CTxIn>& vin){
+    for(const CTxIn& i : vin){
+        if(i.scriptSig.HasOpSpend()){
+            return true;
+        }
+    }
+    return false;
+}
+/////////////////////////////////////////////////////////////
+
 /* For backward compatibility, the hash is initialized to 0. TODO: remove the need for this default constructor entirely. */
-CTransaction::CTransaction() : vin(), vout(), nVersion(CTransaction::CURRENT_VERSION), nLockTime(0), hash() {}
-CTransaction::CTransaction(const CMutableTransaction &tx) : vin(tx.vin), vout(tx.vout), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash(ComputeHash()) {}
-CTransaction::CTransaction(CMutableTransaction &&tx) : vin(std::move(tx.vin)), vout(std::move(tx.vout)), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash(ComputeHash()) {}
+CTransaction::CTransaction() : vin(), vout(), nVersion(CTransaction::CURRENT_VERSION), nLockTime(0), hash(), fHasCreateOrCall(false), fHasOpSpend(false) {}
+CTransaction::CTransaction(const CMutableTransaction &tx) : vin(tx.vin), vout(tx.vout), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash(ComputeHash()), fHasCreateOrCall(OutputsHaveCreateOrCall(vout)), fHasOpSpend(InputsHaveOpSpend(vin)) {}
+CTransaction::CTransaction(CMutableTransaction &&tx) : vin(std::move(tx.vin)), vout(std::move(tx.vout)), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash(ComputeHash()), fHasCreateOrCall(OutputsHaveCreateOrCall(vout)), fHasOpSpend(InputsHaveOpSpend(vin)) {}
+CTransaction::CTransaction(const CTransaction &tx) : vin(tx.vin), vout(tx.vout), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash(tx.hash), fHasCreateOrCall(tx.fHasCreateOrCall), fHasOpSpend(tx.fHasOpSpend), contractOutputs(tx.GetContractOutputs()) {}
 
 CAmount CTransaction::GetValueOut() const
 {
@@ -115,23 +136,11 @@ std::string CTransaction::ToString() const
 }
 
 ///////////////////////////////////////////////////////////// abp
-bool CTransaction::HasCreateOrCall() const{
-    for(const CTxOut& v : vout){
-        if(v.scriptPubKey.HasOpCreate() || v.scriptPubKey.HasOpCall()){
-            return true;
-        }
-    }
-    return false;
+std::shared_ptr<const ContractOutputs> CTransaction::GetContractOutputs() const{
+    return std::atomic_load(&contractOutputs);
 }
 
-
-
-bool CTransaction::HasOpSpend() const{
-    for(const CTxIn& i : vin){
-        if(i.scriptSig.HasOpSpend()){
-            return true;
-        }
-    }
-    return false;
+void CTransaction::SetContractOutputs(std::shared_ptr<const ContractOutputs> outputs) const{
+    std::atomic_store(&contractOutputs, outputs);
 }
 /////////////////////////////////////////////////////////////
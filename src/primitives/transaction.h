@@ -7,6 +7,7 @@
 #define BITCOIN_PRIMITIVES_TRANSACTION_H
 
 #include <stdint.h>
+#include <memory>
 #include <amount.h>
 #include <script/script.h>
 #include <serialize.h>
@@ -14,6 +15,8 @@
 
 static const int SERIALIZE_TRANSACTION_NO_WITNESS = 0x40000000;
 
+struct ContractOutputs;
+
 /** An outpoint - a combination of a transaction hash and an index n into its vout */
 class COutPoint
 {
@@ -297,6 +300,12 @@ public:
 private:
     /** Memory only. */
     const uint256 hash;
+    const bool fHasCreateOrCall;
+    const bool fHasOpSpend;
+
+    /** Contract outputs as parsed by the first AbpTxConverter to see this
+     *  transaction, only accessed with std::atomic_load/store */
+    mutable std::shared_ptr<const ContractOutputs> contractOutputs;
 
     uint256 ComputeHash() const;
 
@@ -307,6 +316,7 @@ public:
     /** Convert a CMutableTransaction into a CTransaction. */
     CTransaction(const CMutableTransaction &tx);
     CTransaction(CMutableTransaction &&tx);
+    CTransaction(const CTransaction &tx);
 
     template <typename Stream>
     inline void Serialize(Stream& s) const {
@@ -342,8 +352,19 @@ public:
     unsigned int GetTotalSize() const;
 
 //////////////////////////////////////// // abp
-    bool HasCreateOrCall() const;
-    bool HasOpSpend() const;
+    bool HasCreateOrCall() const {
+        return fHasCreateOrCall;
+    }
+
+    bool HasOpSpend() const {
+        return fHasOpSpend;
+    }
+
+    std::shared_ptr<const ContractOutputs> GetContractOutputs() const;
+
+    /** The parse is a function of the transaction alone, so it can be shared
+     *  by every copy of it and never needs to be invalidated. */
+    void SetContractOutputs(std::shared_ptr<const ContractOutputs> outputs) const;
 ////////////////////////////////////////
 
     bool IsCoinBase() const
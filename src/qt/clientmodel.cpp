@@ -211,9 +211,9 @@ void ClientModel::getGasInfo(uint64_t& blockGasLimit, uint64_t& minGasPrice, uin
 {
     LOCK(cs_main);
 
-    AbpDGP abpDGP(globalState.get(), fGettingValuesDGP);
-    blockGasLimit = abpDGP.getBlockGasLimit(chainActive.Height());
-    minGasPrice = CAmount(abpDGP.getMinGasPrice(chainActive.Height()));
+    DGPParams dgpParams = GetEVMTipContext()->GetDGPParams(chainActive.Height());
+    blockGasLimit = dgpParams.blockGasLimit;
+    minGasPrice = CAmount(dgpParams.minGasPrice);
     nGasPrice = (minGasPrice>DEFAULT_GAS_PRICE)?minGasPrice:DEFAULT_GAS_PRICE;
 }
 
@@ -0,0 +1,220 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rawblock.h>
+
+#include <clientversion.h>
+#include <serialize.h>
+#include <util.h>
+
+#include <string.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/** Deserializes from a byte range in place, without copying it into a buffer first */
+class CMemoryReader
+{
+public:
+    CMemoryReader(int nTypeIn, int nVersionIn, const unsigned char* pbeginIn, const unsigned char* pendIn)
+        : nType(nTypeIn), nVersion(nVersionIn), pbegin(pbeginIn), pcur(pbeginIn), pend(pendIn) {}
+
+    int GetType() const { return nType; }
+    int GetVersion() const { return nVersion; }
+    size_t Offset() const { return pcur - pbegin; }
+    bool empty() const { return pcur == pend; }
+
+    void read(char* pch, size_t nSize)
+    {
+        if (nSize > (size_t)(pend - pcur))
+            throw std::ios_base::failure("CMemoryReader::read(): end of data");
+        memcpy(pch, pcur, nSize);
+        pcur += nSize;
+    }
+
+    void ignore(uint64_t nSize)
+    {
+        if (nSize > (uint64_t)(pend - pcur))
+            throw std::ios_base::failure("CMemoryReader::ignore(): end of data");
+        pcur += nSize;
+    }
+
+    template<typename T>
+    CMemoryReader& operator>>(T& obj)
+    {
+        ::Unserialize(*this, obj);
+        return *this;
+    }
+
+private:
+    const int nType;
+    const int nVersion;
+    const unsigned char* pbegin;
+    const unsigned char* pcur;
+    const unsigned char* pend;
+};
+
+void SkipInputs(CMemoryReader& s, uint64_t nInputs)
+{
+    for (uint64_t i = 0; i < nInputs; ++i) {
+        s.ignore(32 + 4);                // prevout
+        s.ignore(ReadCompactSize(s));    // scriptSig
+        s.ignore(4);                     // nSequence
+    }
+}
+
+void SkipOutputs(CMemoryReader& s)
+{
+    uint64_t nOutputs = ReadCompactSize(s);
+    for (uint64_t i = 0; i < nOutputs; ++i) {
+        s.ignore(8);                     // nValue
+        s.ignore(ReadCompactSize(s));    // scriptPubKey
+    }
+}
+
+/**
+ * Step over one transaction the way UnserializeTransaction would read it.
+ * Returns whether it was serialized with witness data.
+ */
+bool SkipTransaction(CMemoryReader& s)
+{
+    s.ignore(4); // nVersion
+    unsigned char flags = 0;
+    uint64_t nInputs = ReadCompactSize(s);
+    if (nInputs == 0) {
+        s >> flags;
+        if (flags != 0) {
+            nInputs = ReadCompactSize(s);
+            SkipInputs(s, nInputs);
+            SkipOutputs(s);
+        }
+    } else {
+        SkipInputs(s, nInputs);
+        SkipOutputs(s);
+    }
+    bool fWitness = false;
+    if (flags & 1) {
+        flags ^= 1;
+        fWitness = true;
+        for (uint64_t i = 0; i < nInputs; ++i) {
+            uint64_t nItems = ReadCompactSize(s);
+            for (uint64_t j = 0; j < nItems; ++j)
+                s.ignore(ReadCompactSize(s));
+        }
+    }
+    if (flags)
+        throw std::ios_base::failure("Unknown transaction optional data");
+    s.ignore(4); // nLockTime
+    return fWitness;
+}
+
+#ifndef WIN32
+bool MapFile(const fs::path& path, std::shared_ptr<const void>& mapping, const unsigned char*& pbegin, uint64_t& nLength)
+{
+    int fd = open(path.string().c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    size_t nMapLength = st.st_size;
+    void* addr = mmap(nullptr, nMapLength, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+    mapping = std::shared_ptr<const void>(addr, [nMapLength](const void* p) { munmap(const_cast<void*>(p), nMapLength); });
+    pbegin = static_cast<const unsigned char*>(addr);
+    nLength = nMapLength;
+    return true;
+}
+#endif
+
+} // namespace
+
+CBlockView::CBlockView(const CRawBlock& blockIn) : block(blockIn), nTxEnd(0), fHasWitness(false)
+{
+    CMemoryReader s(SER_DISK, CLIENT_VERSION, block.begin(), block.end());
+    s >> header;
+    uint64_t nTx = ReadCompactSize(s);
+    // Every transaction takes at least ten bytes, don't trust the count beyond that
+    vTxOffset.reserve(std::min<uint64_t>(nTx, block.size() / 10));
+    for (uint64_t i = 0; i < nTx; ++i) {
+        vTxOffset.push_back(s.Offset());
+        if (SkipTransaction(s))
+            fHasWitness = true;
+    }
+    nTxEnd = s.Offset();
+    if (!s.empty())
+        throw std::ios_base::failure("CBlockView: data after the last transaction");
+}
+
+CTransactionRef CBlockView::GetTransaction(size_t n) const
+{
+    const unsigned char* ptx = block.begin() + vTxOffset[n];
+    CMemoryReader s(SER_DISK, CLIENT_VERSION, ptx, ptx + GetTxSize(n));
+    return std::make_shared<const CTransaction>(deserialize, s);
+}
+
+CRawBlock CBlockFileMap::Read(int nFile, const fs::path& path, uint64_t nPos, size_t nSize)
+{
+#ifdef WIN32
+    // No mapping on this platform, the range gets a buffer of its own instead
+    FILE* file = fsbridge::fopen(path, "rb");
+    if (!file)
+        return CRawBlock();
+    std::shared_ptr<std::vector<unsigned char>> buffer = std::make_shared<std::vector<unsigned char>>(nSize);
+    bool fRead = fseek(file, nPos, SEEK_SET) == 0 && fread(buffer->data(), 1, nSize, file) == nSize;
+    fclose(file);
+    if (!fRead)
+        return CRawBlock();
+    return CRawBlock(buffer, buffer->data(), nSize);
+#else
+    LOCK(cs);
+    std::map<int, MappedFile>::iterator it = mapFiles.find(nFile);
+    if (it == mapFiles.end() || it->second.nLength < nPos + nSize) {
+        // Not mapped yet, or the file has grown since. Readers of the old
+        // mapping keep it alive until they are done.
+        MappedFile mapped;
+        if (!MapFile(path, mapped.mapping, mapped.pbegin, mapped.nLength))
+            return CRawBlock();
+        if (it == mapFiles.end()) {
+            if (mapFiles.size() >= nMaxFiles) {
+                std::map<int, MappedFile>::iterator itOldest = mapFiles.begin();
+                for (std::map<int, MappedFile>::iterator itFile = mapFiles.begin(); itFile != mapFiles.end(); ++itFile) {
+                    if (itFile->second.nLastUse < itOldest->second.nLastUse)
+                        itOldest = itFile;
+                }
+                mapFiles.erase(itOldest);
+            }
+            it = mapFiles.emplace(nFile, mapped).first;
+        } else {
+            it->second = mapped;
+        }
+        if (it->second.nLength < nPos + nSize)
+            return CRawBlock();
+    }
+    it->second.nLastUse = ++nUseCounter;
+    return CRawBlock(it->second.mapping, it->second.pbegin + nPos, nSize);
+#endif
+}
+
+void CBlockFileMap::Forget(int nFile)
+{
+    LOCK(cs);
+    mapFiles.erase(nFile);
+}
+
+void CBlockFileMap::Clear()
+{
+    LOCK(cs);
+    mapFiles.clear();
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RAWBLOCK_H
+#define BITCOIN_RAWBLOCK_H
+
+#include <fs.h>
+#include <primitives/block.h>
+#include <sync.h>
+
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Bytes of a block file, exactly as they are stored on disk. The memory is
+ * owned by whatever backs it (a read-only mapping of the file, or a buffer on
+ * platforms without one), and every copy keeps it alive.
+ */
+class CRawBlock
+{
+public:
+    CRawBlock() : pbegin(nullptr), nSize(0) {}
+    CRawBlock(std::shared_ptr<const void> ownerIn, const unsigned char* pbeginIn, size_t nSizeIn)
+        : owner(std::move(ownerIn)), pbegin(pbeginIn), nSize(nSizeIn) {}
+
+    const unsigned char* data() const { return pbegin; }
+    const unsigned char* begin() const { return pbegin; }
+    const unsigned char* end() const { return pbegin + nSize; }
+    size_t size() const { return nSize; }
+    bool IsNull() const { return pbegin == nullptr; }
+
+private:
+    std::shared_ptr<const void> owner;
+    const unsigned char* pbegin;
+    size_t nSize;
+};
+
+/**
+ * A serialized block together with the offsets of its transactions. Only the
+ * header is deserialized; transactions are located by walking their encoding
+ * and are materialized one at a time on request.
+ */
+class CBlockView
+{
+public:
+    CBlockView() : fHasWitness(false) {}
+    /** Throws std::ios_base::failure if the bytes are not exactly one block */
+    explicit CBlockView(const CRawBlock& blockIn);
+
+    bool IsNull() const { return block.IsNull(); }
+    const CRawBlock& GetRawBlock() const { return block; }
+    const CBlockHeader& GetHeader() const { return header; }
+    uint256 GetHash() const { return header.GetHash(); }
+
+    size_t GetTxCount() const { return vTxOffset.size(); }
+    /** Offset and length of transaction n within the raw block, witness included */
+    size_t GetTxOffset(size_t n) const { return vTxOffset[n]; }
+    size_t GetTxSize(size_t n) const { return (n + 1 < vTxOffset.size() ? vTxOffset[n + 1] : nTxEnd) - vTxOffset[n]; }
+    CTransactionRef GetTransaction(size_t n) const;
+
+    /** Whether any transaction carries witness data, i.e. the bytes differ from the non-witness encoding */
+    bool HasWitness() const { return fHasWitness; }
+
+private:
+    CRawBlock block;
+    CBlockHeader header;
+    std::vector<size_t> vTxOffset;
+    size_t nTxEnd;
+    bool fHasWitness;
+};
+
+/**
+ * Read-only mappings of block files, shared by concurrent readers and reused
+ * across reads. Mappings are remapped when a read runs past the end of a file
+ * that has grown, and the least recently used one is dropped when there are
+ * more than nMaxFiles.
+ */
+class CBlockFileMap
+{
+public:
+    static const size_t DEFAULT_MAX_FILES = 8;
+
+    explicit CBlockFileMap(size_t nMaxFilesIn = DEFAULT_MAX_FILES) : nMaxFiles(nMaxFilesIn), nUseCounter(0) {}
+
+    /** Return nSize bytes at nPos of block file nFile at path, or a null CRawBlock */
+    CRawBlock Read(int nFile, const fs::path& path, uint64_t nPos, size_t nSize);
+    /** Drop the mapping of a file that is about to be deleted */
+    void Forget(int nFile);
+    void Clear();
+
+private:
+    struct MappedFile {
+        std::shared_ptr<const void> mapping;
+        const unsigned char* pbegin;
+        uint64_t nLength;
+        uint64_t nLastUse;
+    };
+
+    CCriticalSection cs;
+    std::map<int, MappedFile> mapFiles;
+    size_t nMaxFiles;
+    uint64_t nUseCounter;
+};
+
+#endif // BITCOIN_RAWBLOCK_H
@@ -8,21 +8,26 @@
 #include <core_io.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <rawblock.h>
 #include <validation.h>
 #include <httpserver.h>
 #include <rpc/blockchain.h>
 #include <rpc/server.h>
 #include <streams.h>
 #include <sync.h>
+#include <txdb.h>
 #include <txmempool.h>
 #include <utilstrencodings.h>
 #include <version.h>
+#include <abp/abpstate.h>
 
 #include <boost/algorithm/string.hpp>
 
 #include <univalue.h>
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const int MAX_LOGS_BLOCKS = 2000; //allow a max of 2000 blocks to be searched for logs at once
+static const int REST_TIP_MAX_AGE = 10; //seconds HTTP caches may keep replies that follow the chain tip
 
 enum RetFormat {
     RF_UNDEF,
@@ -113,6 +118,34 @@ static bool ParseHashStr(const std::string& strReq, uint256& v)
     return true;
 }
 
+static bool ParseAddressStr(const std::string& strReq, dev::h160& v)
+{
+    if (!IsHex(strReq) || (strReq.size() != 40))
+        return false;
+
+    v = dev::h160(strReq);
+    return true;
+}
+
+/** Split the query string off strReq, returning the path part */
+static std::string ParseQueryString(const std::string& strReq, std::multimap<std::string, std::string>& query)
+{
+    const std::string::size_type pos = strReq.find('?');
+    if (pos == std::string::npos)
+        return strReq;
+
+    std::vector<std::string> pairs;
+    std::string strQuery = strReq.substr(pos + 1);
+    boost::split(pairs, strQuery, boost::is_any_of("&"));
+    for (const std::string& pair : pairs) {
+        if (pair.empty())
+            continue;
+        const std::string::size_type eq = pair.find('=');
+        query.emplace(pair.substr(0, eq), eq == std::string::npos ? "" : pair.substr(eq + 1));
+    }
+    return strReq.substr(0, pos);
+}
+
 static bool CheckWarmup(HTTPRequest* req)
 {
     std::string statusmessage;
@@ -121,6 +154,26 @@ static bool CheckWarmup(HTTPRequest* req)
     return true;
 }
 
+/**
+ * Let HTTP caches keep a reply computed from the chain as of hashBlock. Replies
+ * to requests that name the block themselves never change; the others follow
+ * the tip, so they are only kept briefly and revalidated with the ETag.
+ * Returns true if the client already has this reply and 304 has been sent.
+ */
+static bool WriteCacheHeaders(HTTPRequest* req, const uint256& hashBlock, bool fPinned)
+{
+    const std::string strETag = "\"" + hashBlock.GetHex() + "\"";
+    req->WriteHeader("ETag", strETag);
+    req->WriteHeader("Cache-Control", fPinned ? "public, max-age=31536000, immutable" : strprintf("public, max-age=%d", REST_TIP_MAX_AGE));
+
+    std::pair<bool, std::string> ifNoneMatch = req->GetHeader("If-None-Match");
+    if (ifNoneMatch.first && ifNoneMatch.second == strETag) {
+        req->WriteReply(HTTP_NOT_MODIFIED);
+        return true;
+    }
+    return false;
+}
+
 static bool rest_headers(HTTPRequest* req,
                          const std::string& strURIPart)
 {
@@ -209,6 +262,8 @@ static bool rest_block(HTTPRequest* req,
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
     CBlock block;
+    CBlockView view;
+    bool fRaw = false;
     CBlockIndex* pblockindex = nullptr;
     {
         LOCK(cs_main);
@@ -219,12 +274,18 @@ static bool rest_block(HTTPRequest* req,
         if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+        // Binary and hex replies are the stored bytes when those are in the requested encoding
+        fRaw = rf != RF_JSON && ReadRawBlockFromDisk(view, pblockindex, Params().MessageStart()) &&
+               !(view.HasWitness() && (RPCSerializationFlags() & SERIALIZE_TRANSACTION_NO_WITNESS));
+        if (!fRaw && !ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
     }
 
     CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    ssBlock << block;
+    if (fRaw)
+        ssBlock.write((const char*)view.GetRawBlock().data(), view.GetRawBlock().size());
+    else
+        ssBlock << block;
 
     switch (rf) {
     case RF_BINARY: {
@@ -570,6 +631,437 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
     }
 }
 
+template <typename Stream, unsigned N>
+static void WriteFixedHash(Stream& s, const dev::FixedHash<N>& hash)
+{
+    s.write((const char*)hash.data(), N);
+}
+
+static void WriteReceiptHeader(CDataStream& s, const TransactionReceiptInfo& receipt)
+{
+    s << receipt.blockHash << receipt.blockNumber << receipt.transactionHash << receipt.transactionIndex;
+}
+
+static void WriteLogEntry(CDataStream& s, const dev::eth::LogEntry& log)
+{
+    WriteFixedHash(s, log.address);
+    WriteCompactSize(s, log.topics.size());
+    for (const dev::h256& topic : log.topics)
+        WriteFixedHash(s, topic);
+    s << log.data;
+}
+
+static bool rest_receipt(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    if (!fLogEvents)
+        return RESTERR(req, HTTP_NOT_FOUND, "Events indexing disabled");
+    std::string hashStr;
+    const RetFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    uint256 hash;
+    if (!ParseHashStr(hashStr, hash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+
+    // Receipts are read from the results database without cs_main. They stay
+    // there for as long as their block is in the active chain.
+    std::vector<TransactionReceiptInfo> receipts;
+    if (!pstorageresult->getCommittedResult(uintToh256(hash), receipts) || receipts.empty())
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+
+    if (WriteCacheHeaders(req, receipts[0].blockHash, false))
+        return true;
+
+    CDataStream ssReceipts(SER_NETWORK, PROTOCOL_VERSION);
+    WriteCompactSize(ssReceipts, receipts.size());
+    for (const TransactionReceiptInfo& receipt : receipts) {
+        WriteReceiptHeader(ssReceipts, receipt);
+        WriteFixedHash(ssReceipts, receipt.from);
+        WriteFixedHash(ssReceipts, receipt.to);
+        ssReceipts << receipt.cumulativeGasUsed << receipt.gasUsed;
+        WriteFixedHash(ssReceipts, receipt.contractAddress);
+        ssReceipts << uint32_t(receipt.excepted);
+        WriteCompactSize(ssReceipts, receipt.logs.size());
+        for (const dev::eth::LogEntry& log : receipt.logs)
+            WriteLogEntry(ssReceipts, log);
+    }
+
+    switch (rf) {
+    case RF_BINARY: {
+        std::string binaryReceipts = ssReceipts.str();
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, binaryReceipts);
+        return true;
+    }
+
+    case RF_HEX: {
+        std::string strHex = HexStr(ssReceipts.begin(), ssReceipts.end()) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RF_JSON: {
+        UniValue jsonReceipts(UniValue::VARR);
+        for (const TransactionReceiptInfo& receipt : receipts) {
+            UniValue tri(UniValue::VOBJ);
+            transactionReceiptInfoToJSON(receipt, tri);
+            jsonReceipts.push_back(tri);
+        }
+        std::string strJSON = jsonReceipts.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_logs(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    if (!fLogEvents)
+        return RESTERR(req, HTTP_NOT_FOUND, "Events indexing disabled");
+    std::multimap<std::string, std::string> query;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, ParseQueryString(strURIPart, query));
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No block range specified. Use /rest/logs/<from>/<to>.<ext>?address=<address>&topic=<topic>.");
+
+    int32_t nFromHeight, nToHeight;
+    if (!ParseInt32(path[0], &nFromHeight) || !ParseInt32(path[1], &nToHeight) || nFromHeight < 0 || nToHeight < nFromHeight)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid block range: " + param);
+    if (nToHeight - nFromHeight >= MAX_LOGS_BLOCKS)
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Error: max blocks exceeded (max: %d, tried: %d)", MAX_LOGS_BLOCKS, nToHeight - nFromHeight + 1));
+
+    // Logs match if they come from one of the addresses and carry one of the
+    // topics, an empty set matching everything.
+    std::set<dev::h160> addresses;
+    std::set<dev::h256> topics;
+    for (const auto& q : query) {
+        if (q.first == "address") {
+            dev::h160 address;
+            if (!ParseAddressStr(q.second, address))
+                return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + q.second);
+            addresses.insert(address);
+        } else if (q.first == "topic") {
+            uint256 topic;
+            if (!ParseHashStr(q.second, topic))
+                return RESTERR(req, HTTP_BAD_REQUEST, "Invalid topic: " + q.second);
+            topics.insert(dev::h256(q.second));
+        } else {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Unknown parameter: " + q.first);
+        }
+    }
+
+    // The logs up to a block are determined by its hash, so only the block
+    // lookup needs cs_main. The indexes are read from the databases directly.
+    uint256 hashBlock;
+    {
+        LOCK(cs_main);
+        if (nToHeight > chainActive.Height())
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range: " + path[1]);
+        hashBlock = chainActive[nToHeight]->GetBlockHash();
+    }
+
+    if (WriteCacheHeaders(req, hashBlock, false))
+        return true;
+
+    std::vector<std::vector<uint256>> hashesToBlock;
+    if (pblocktree->ReadHeightIndex(nFromHeight, nToHeight, 0, hashesToBlock, addresses) == -1)
+        hashesToBlock.clear();
+
+    std::set<uint256> dupes;
+    std::vector<TransactionReceiptInfo> receipts;
+    for (const std::vector<uint256>& hashesTx : hashesToBlock) {
+        for (const uint256& hashTx : hashesTx) {
+            if (!dupes.insert(hashTx).second)
+                continue;
+            pstorageresult->getCommittedResult(uintToh256(hashTx), receipts);
+        }
+    }
+
+    std::vector<std::pair<const TransactionReceiptInfo*, uint32_t>> matches;
+    for (const TransactionReceiptInfo& receipt : receipts) {
+        for (size_t i = 0; i < receipt.logs.size(); i++) {
+            const dev::eth::LogEntry& log = receipt.logs[i];
+            if (!addresses.empty() && !addresses.count(log.address))
+                continue;
+            if (!topics.empty() && std::none_of(log.topics.begin(), log.topics.end(), [&topics](const dev::h256& topic) { return topics.count(topic) != 0; }))
+                continue;
+            matches.emplace_back(&receipt, (uint32_t)i);
+        }
+    }
+
+    switch (rf) {
+    case RF_BINARY:
+    case RF_HEX: {
+        CDataStream ssLogs(SER_NETWORK, PROTOCOL_VERSION);
+        WriteCompactSize(ssLogs, matches.size());
+        for (const auto& match : matches) {
+            WriteReceiptHeader(ssLogs, *match.first);
+            ssLogs << match.second;
+            WriteLogEntry(ssLogs, match.first->logs[match.second]);
+        }
+
+        if (rf == RF_BINARY) {
+            std::string binaryLogs = ssLogs.str();
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, binaryLogs);
+        } else {
+            std::string strHex = HexStr(ssLogs.begin(), ssLogs.end()) + "\n";
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, strHex);
+        }
+        return true;
+    }
+
+    case RF_JSON: {
+        UniValue jsonLogs(UniValue::VARR);
+        for (const auto& match : matches) {
+            const TransactionReceiptInfo& receipt = *match.first;
+            UniValue logEntry(UniValue::VOBJ);
+            logEntry.push_back(Pair("blockHash", receipt.blockHash.GetHex()));
+            logEntry.push_back(Pair("blockNumber", uint64_t(receipt.blockNumber)));
+            logEntry.push_back(Pair("transactionHash", receipt.transactionHash.GetHex()));
+            logEntry.push_back(Pair("transactionIndex", uint64_t(receipt.transactionIndex)));
+            logEntry.push_back(Pair("logIndex", uint64_t(match.second)));
+            assignJSON(logEntry, receipt.logs[match.second], true);
+            jsonLogs.push_back(logEntry);
+        }
+        std::string strJSON = jsonLogs.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+/**
+ * Contract state as of one block. The tries are read through private copies
+ * of the state databases: nodes are never removed from disk, so once the roots
+ * are known the state can be walked without cs_main while blocks connect.
+ */
+struct CContractStateView
+{
+    uint256 hashBlock;
+    bool fPinned;
+    std::unique_ptr<dev::eth::State> state;
+    dev::OverlayDB dbUTXO;
+    dev::h256 hashUTXORoot;
+
+    CContractStateView() : fPinned(false) {}
+};
+
+/** Resolve the block named by ?block=<hash>, or the tip, into view */
+static bool GetContractStateView(HTTPRequest* req, const std::multimap<std::string, std::string>& query, CContractStateView& view)
+{
+    dev::h256 hashStateRoot;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* pindex = chainActive.Tip();
+        auto it = query.find("block");
+        if (it != query.end()) {
+            uint256 hash;
+            if (!ParseHashStr(it->second, hash))
+                return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + it->second);
+            BlockMap::const_iterator mi = mapBlockIndex.find(hash);
+            // Only blocks that have been connected have their state on disk
+            if (mi == mapBlockIndex.end() || !mi->second->IsValid(BLOCK_VALID_SCRIPTS))
+                return RESTERR(req, HTTP_NOT_FOUND, it->second + " not found");
+            pindex = mi->second;
+            view.fPinned = true;
+        }
+        view.hashBlock = pindex->GetBlockHash();
+        hashStateRoot = uintToh256(pindex->hashStateRoot);
+        view.hashUTXORoot = uintToh256(pindex->hashUTXORoot);
+        view.state.reset(new dev::eth::State(dev::u256(0), globalState->db(), dev::eth::BaseState::PreExisting));
+        view.dbUTXO = globalState->dbUtxo();
+    }
+
+    try {
+        view.state->setRoot(hashStateRoot);
+    } catch (const dev::Exception& e) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "State not available: " + view.hashBlock.GetHex());
+    }
+    return true;
+}
+
+static bool rest_storage(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::multimap<std::string, std::string> query;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, ParseQueryString(strURIPart, query));
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No storage slot specified. Use /rest/storage/<address>/<slot>.<ext>?block=<hash>.");
+
+    dev::h160 address;
+    if (!ParseAddressStr(path[0], address))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + path[0]);
+    uint256 slot;
+    if (!ParseHashStr(path[1], slot))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid slot: " + path[1]);
+
+    CContractStateView view;
+    if (!GetContractStateView(req, query, view))
+        return false;
+    if (WriteCacheHeaders(req, view.hashBlock, view.fPinned))
+        return true;
+
+    dev::h256 value;
+    try {
+        if (!view.state->addressInUse(address))
+            return RESTERR(req, HTTP_NOT_FOUND, path[0] + " not found");
+        value = dev::h256(view.state->storage(address, dev::u256(dev::h256(path[1]))));
+    } catch (const dev::Exception& e) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "State not available: " + view.hashBlock.GetHex());
+    }
+
+    switch (rf) {
+    case RF_BINARY: {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, std::string((const char*)value.data(), value.size));
+        return true;
+    }
+
+    case RF_HEX: {
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, value.hex() + "\n");
+        return true;
+    }
+
+    case RF_JSON: {
+        UniValue objStorage(UniValue::VOBJ);
+        objStorage.push_back(Pair("blockhash", view.hashBlock.GetHex()));
+        objStorage.push_back(Pair("address", address.hex()));
+        objStorage.push_back(Pair("slot", path[1]));
+        objStorage.push_back(Pair("value", value.hex()));
+        std::string strJSON = objStorage.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_account(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::multimap<std::string, std::string> query;
+    std::string strAddress;
+    const RetFormat rf = ParseDataFormat(strAddress, ParseQueryString(strURIPart, query));
+
+    dev::h160 address;
+    if (!ParseAddressStr(strAddress, address))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + strAddress);
+
+    CContractStateView view;
+    if (!GetContractStateView(req, query, view))
+        return false;
+    if (WriteCacheHeaders(req, view.hashBlock, view.fPinned))
+        return true;
+
+    CAmount balance;
+    dev::bytes code;
+    dev::h256 codeHash, storageRoot;
+    bool fHaveVin = false;
+    Vin vin;
+    try {
+        if (!view.state->addressInUse(address))
+            return RESTERR(req, HTTP_NOT_FOUND, strAddress + " not found");
+        balance = CAmount(view.state->balance(address));
+        code = view.state->code(address);
+        codeHash = view.state->codeHash(address);
+        storageRoot = view.state->storageRoot(address);
+
+        dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> stateUTXO(&view.dbUTXO, view.hashUTXORoot);
+        std::string stateBack = stateUTXO.at(address);
+        if (!stateBack.empty()) {
+            dev::RLP rlp(stateBack);
+            vin = Vin{rlp[0].toHash<dev::h256>(), rlp[1].toInt<uint32_t>(), rlp[2].toInt<dev::u256>(), rlp[3].toInt<uint8_t>()};
+            fHaveVin = vin.alive != 0;
+        }
+    } catch (const dev::Exception& e) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "State not available: " + view.hashBlock.GetHex());
+    }
+
+    switch (rf) {
+    case RF_BINARY:
+    case RF_HEX: {
+        CDataStream ssAccount(SER_NETWORK, PROTOCOL_VERSION);
+        ssAccount << view.hashBlock;
+        WriteFixedHash(ssAccount, address);
+        ssAccount << balance;
+        WriteFixedHash(ssAccount, codeHash);
+        WriteFixedHash(ssAccount, storageRoot);
+        ssAccount << code << fHaveVin;
+        if (fHaveVin) {
+            WriteFixedHash(ssAccount, vin.hash);
+            ssAccount << vin.nVout << CAmount(vin.value);
+        }
+
+        if (rf == RF_BINARY) {
+            std::string binaryAccount = ssAccount.str();
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, binaryAccount);
+        } else {
+            std::string strHex = HexStr(ssAccount.begin(), ssAccount.end()) + "\n";
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, strHex);
+        }
+        return true;
+    }
+
+    case RF_JSON: {
+        UniValue objAccount(UniValue::VOBJ);
+        objAccount.push_back(Pair("blockhash", view.hashBlock.GetHex()));
+        objAccount.push_back(Pair("address", address.hex()));
+        objAccount.push_back(Pair("balance", balance));
+        objAccount.push_back(Pair("codehash", codeHash.hex()));
+        objAccount.push_back(Pair("storageroot", storageRoot.hex()));
+        objAccount.push_back(Pair("code", HexStr(code.begin(), code.end())));
+        if (fHaveVin) {
+            UniValue objVin(UniValue::VOBJ);
+            valtype vchHash(vin.hash.asBytes());
+            objVin.push_back(Pair("hash", HexStr(vchHash.rbegin(), vchHash.rend())));
+            objVin.push_back(Pair("nVout", uint64_t(vin.nVout)));
+            objVin.push_back(Pair("value", uint64_t(vin.value)));
+            objAccount.push_back(Pair("vin", objVin));
+        }
+        std::string strJSON = objAccount.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
@@ -582,6 +1074,10 @@ static const struct {
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
+      {"/rest/receipt/", rest_receipt},
+      {"/rest/logs/", rest_logs},
+      {"/rest/storage/", rest_storage},
+      {"/rest/account/", rest_account},
 };
 
 bool StartREST()
@@ -11,12 +11,14 @@
 #include <chainparams.h>
 #include <checkpoints.h>
 #include <coins.h>
+#include <coinstats.h>
 #include <consensus/validation.h>
 #include <validation.h>
 #include <core_io.h>
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <rawblock.h>
 #include <rpc/server.h>
 #include <streams.h>
 #include <sync.h>
@@ -314,6 +316,32 @@ void RPCNotifyBlockChange(bool ibd, const CBlockIndex * pindex)
         latestblock.height = pindex->nHeight;
     }
     cond_blockchange.notify_all();
+    WakeParkedHTTPRequests();
+}
+
+/**
+ * Wait until fDone(latestblock) holds, timeout milliseconds (0 for no timeout)
+ * have passed or RPC stops, and return latestblock. Requests that can be
+ * parked do not block here: they throw RPCLongPollPending carrying state and
+ * their deadline, and are called again on the next tip change.
+ */
+static CUpdatedBlock WaitForBlockChange(const JSONRPCRequest& request, int timeout, const std::function<bool(const CUpdatedBlock&)>& fDone, UniValue state = UniValue(UniValue::VOBJ))
+{
+    std::unique_lock<std::mutex> lock(cs_blockchange);
+    if (request.fCanPark) {
+        int64_t nDeadline = timeout ? GetTimeMillis() + timeout : 0;
+        if (!request.pollState.isNull())
+            nDeadline = find_value(request.pollState, "deadline").get_int64();
+        if (!fDone(latestblock) && IsRPCRunning() && (!nDeadline || GetTimeMillis() < nDeadline)) {
+            state.pushKV("deadline", nDeadline);
+            throw RPCLongPollPending{nDeadline, state};
+        }
+    } else if (timeout) {
+        cond_blockchange.wait_for(lock, std::chrono::milliseconds(timeout), [&fDone]{return fDone(latestblock) || !IsRPCRunning();});
+    } else {
+        cond_blockchange.wait(lock, [&fDone]{return fDone(latestblock) || !IsRPCRunning();});
+    }
+    return latestblock;
 }
 
 UniValue waitfornewblock(const JSONRPCRequest& request)
@@ -338,16 +366,19 @@ UniValue waitfornewblock(const JSONRPCRequest& request)
     if (!request.params[0].isNull())
         timeout = request.params[0].get_int();
 
+    // A parked request resumes waiting for a change from the block it started at
     CUpdatedBlock block;
-    {
-        std::unique_lock<std::mutex> lock(cs_blockchange);
-        block = latestblock;
-        if(timeout)
-            cond_blockchange.wait_for(lock, std::chrono::milliseconds(timeout), [&block]{return latestblock.height != block.height || latestblock.hash != block.hash || !IsRPCRunning(); });
-        else
-            cond_blockchange.wait(lock, [&block]{return latestblock.height != block.height || latestblock.hash != block.hash || !IsRPCRunning(); });
+    if (!request.pollState.isNull()) {
+        block.hash = uint256S(find_value(request.pollState, "hash").get_str());
+        block.height = find_value(request.pollState, "height").get_int();
+    } else {
+        std::lock_guard<std::mutex> lock(cs_blockchange);
         block = latestblock;
     }
+    UniValue state(UniValue::VOBJ);
+    state.pushKV("hash", block.hash.GetHex());
+    state.pushKV("height", block.height);
+    block = WaitForBlockChange(request, timeout, [&block](const CUpdatedBlock& latest){return latest.height != block.height || latest.hash != block.hash;}, state);
     UniValue ret(UniValue::VOBJ);
     ret.push_back(Pair("hash", block.hash.GetHex()));
     ret.push_back(Pair("height", block.height));
@@ -380,15 +411,7 @@ UniValue waitforblock(const JSONRPCRequest& request)
     if (!request.params[1].isNull())
         timeout = request.params[1].get_int();
 
-    CUpdatedBlock block;
-    {
-        std::unique_lock<std::mutex> lock(cs_blockchange);
-        if(timeout)
-            cond_blockchange.wait_for(lock, std::chrono::milliseconds(timeout), [&hash]{return latestblock.hash == hash || !IsRPCRunning();});
-        else
-            cond_blockchange.wait(lock, [&hash]{return latestblock.hash == hash || !IsRPCRunning(); });
-        block = latestblock;
-    }
+    CUpdatedBlock block = WaitForBlockChange(request, timeout, [&hash](const CUpdatedBlock& latest){return latest.hash == hash;});
 
     UniValue ret(UniValue::VOBJ);
     ret.push_back(Pair("hash", block.hash.GetHex()));
@@ -423,15 +446,7 @@ UniValue waitforblockheight(const JSONRPCRequest& request)
     if (!request.params[1].isNull())
         timeout = request.params[1].get_int();
 
-    CUpdatedBlock block;
-    {
-        std::unique_lock<std::mutex> lock(cs_blockchange);
-        if(timeout)
-            cond_blockchange.wait_for(lock, std::chrono::milliseconds(timeout), [&height]{return latestblock.height >= height || !IsRPCRunning();});
-        else
-            cond_blockchange.wait(lock, [&height]{return latestblock.height >= height || !IsRPCRunning(); });
-        block = latestblock;
-    }
+    CUpdatedBlock block = WaitForBlockChange(request, timeout, [&height](const CUpdatedBlock& latest){return latest.height >= height;});
     UniValue ret(UniValue::VOBJ);
     ret.push_back(Pair("hash", block.hash.GetHex()));
     ret.push_back(Pair("height", block.height));
@@ -493,67 +508,69 @@ std::string EntryDescriptionString()
            "       ... ]\n";
 }
 
-void entryToJSON(UniValue &info, const CTxMemPoolEntry &e)
+const UniValue& entryToJSON(const CTxMemPoolSnapshotEntry& e)
 {
-    AssertLockHeld(mempool.cs);
-
-    info.push_back(Pair("size", (int)e.GetTxSize()));
-    info.push_back(Pair("fee", ValueFromAmount(e.GetFee())));
-    info.push_back(Pair("modifiedfee", ValueFromAmount(e.GetModifiedFee())));
-    info.push_back(Pair("time", e.GetTime()));
-    info.push_back(Pair("height", (int)e.GetHeight()));
-    info.push_back(Pair("descendantcount", e.GetCountWithDescendants()));
-    info.push_back(Pair("descendantsize", e.GetSizeWithDescendants()));
-    info.push_back(Pair("descendantfees", e.GetModFeesWithDescendants()));
-    info.push_back(Pair("ancestorcount", e.GetCountWithAncestors()));
-    info.push_back(Pair("ancestorsize", e.GetSizeWithAncestors()));
-    info.push_back(Pair("ancestorfees", e.GetModFeesWithAncestors()));
-    info.push_back(Pair("wtxid", mempool.vTxHashes[e.vTxHashesIdx].first.ToString()));
-    const CTransaction& tx = e.GetTx();
-    std::set<std::string> setDepends;
-    for (const CTxIn& txin : tx.vin)
-    {
-        if (mempool.exists(txin.prevout.hash))
-            setDepends.insert(txin.prevout.hash.ToString());
-    }
+    // Built once per entry; unchanged entries carry it over to later snapshots
+    std::call_once(e.jsonOnce, [&e]() {
+        UniValue info(UniValue::VOBJ);
+        info.push_back(Pair("size", (int)e.nTxSize));
+        info.push_back(Pair("fee", ValueFromAmount(e.nFee)));
+        info.push_back(Pair("modifiedfee", ValueFromAmount(e.nModFee)));
+        info.push_back(Pair("time", e.nTime));
+        info.push_back(Pair("height", (int)e.nHeight));
+        info.push_back(Pair("descendantcount", e.nCountWithDescendants));
+        info.push_back(Pair("descendantsize", e.nSizeWithDescendants));
+        info.push_back(Pair("descendantfees", e.nModFeesWithDescendants));
+        info.push_back(Pair("ancestorcount", e.nCountWithAncestors));
+        info.push_back(Pair("ancestorsize", e.nSizeWithAncestors));
+        info.push_back(Pair("ancestorfees", e.nModFeesWithAncestors));
+        info.push_back(Pair("wtxid", e.wtxid.ToString()));
+        std::set<std::string> setDepends;
+        for (const uint256& parent : e.vParents)
+        {
+            setDepends.insert(parent.ToString());
+        }
 
-    UniValue depends(UniValue::VARR);
-    for (const std::string& dep : setDepends)
-    {
-        depends.push_back(dep);
-    }
+        UniValue depends(UniValue::VARR);
+        for (const std::string& dep : setDepends)
+        {
+            depends.push_back(dep);
+        }
 
-    info.push_back(Pair("depends", depends));
+        info.push_back(Pair("depends", depends));
+        e.json.reset(new UniValue(info));
+    });
+    return *e.json;
 }
 
 UniValue mempoolToJSON(bool fVerbose)
 {
+    CTxMemPoolSnapshotRef snapshot = mempool.GetSnapshot();
     if (fVerbose)
     {
-        LOCK(mempool.cs);
         UniValue o(UniValue::VOBJ);
-        for (const CTxMemPoolEntry& e : mempool.mapTx)
+        for (const CTxMemPoolSnapshotEntryRef& e : snapshot->vEntries)
         {
-            const uint256& hash = e.GetTx().GetHash();
-            UniValue info(UniValue::VOBJ);
-            entryToJSON(info, e);
-            o.push_back(Pair(hash.ToString(), info));
+            o.push_back(Pair(e->tx->GetHash().ToString(), entryToJSON(*e)));
         }
         return o;
     }
     else
     {
-        std::vector<uint256> vtxid;
-        mempool.queryHashes(vtxid);
-
         UniValue a(UniValue::VARR);
-        for (const uint256& hash : vtxid)
-            a.push_back(hash.ToString());
+        for (const CTxMemPoolSnapshotEntryRef& e : snapshot->vEntries)
+            a.push_back(e->tx->GetHash().ToString());
 
         return a;
     }
 }
 
+/** Order snapshot entries by txid, as the mempool's own entry sets are */
+static bool CompareSnapshotEntryByTxid(const CTxMemPoolSnapshotEntry* a, const CTxMemPoolSnapshotEntry* b)
+{
+    return a->tx->GetHash() < b->tx->GetHash();
+}
+
 UniValue getrawmempool(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 1)
@@ -618,33 +635,28 @@ UniValue getmempoolancestors(const JSONRPCRequest& request)
 
     uint256 hash = ParseHashV(request.params[0], "parameter 1");
 
-    LOCK(mempool.cs);
+    CTxMemPoolSnapshotRef snapshot = mempool.GetSnapshot();
 
-    CTxMemPool::txiter it = mempool.mapTx.find(hash);
-    if (it == mempool.mapTx.end()) {
+    const CTxMemPoolSnapshotEntry* entry = snapshot->find(hash);
+    if (entry == nullptr) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not in mempool");
     }
 
-    CTxMemPool::setEntries setAncestors;
-    uint64_t noLimit = std::numeric_limits<uint64_t>::max();
-    std::string dummy;
-    mempool.CalculateMemPoolAncestors(*it, setAncestors, noLimit, noLimit, noLimit, noLimit, dummy, false);
+    std::vector<const CTxMemPoolSnapshotEntry*> vAncestors;
+    snapshot->CalculateAncestors(*entry, vAncestors);
+    std::sort(vAncestors.begin(), vAncestors.end(), CompareSnapshotEntryByTxid);
 
     if (!fVerbose) {
         UniValue o(UniValue::VARR);
-        for (CTxMemPool::txiter ancestorIt : setAncestors) {
-            o.push_back(ancestorIt->GetTx().GetHash().ToString());
+        for (const CTxMemPoolSnapshotEntry* ancestor : vAncestors) {
+            o.push_back(ancestor->tx->GetHash().ToString());
         }
 
         return o;
     } else {
         UniValue o(UniValue::VOBJ);
-        for (CTxMemPool::txiter ancestorIt : setAncestors) {
-            const CTxMemPoolEntry &e = *ancestorIt;
-            const uint256& _hash = e.GetTx().GetHash();
-            UniValue info(UniValue::VOBJ);
-            entryToJSON(info, e);
-            o.push_back(Pair(_hash.ToString(), info));
+        for (const CTxMemPoolSnapshotEntry* ancestor : vAncestors) {
+            o.push_back(Pair(ancestor->tx->GetHash().ToString(), entryToJSON(*ancestor)));
         }
         return o;
     }
@@ -682,33 +694,28 @@ UniValue getmempooldescendants(const JSONRPCRequest& request)
 
     uint256 hash = ParseHashV(request.params[0], "parameter 1");
 
-    LOCK(mempool.cs);
+    CTxMemPoolSnapshotRef snapshot = mempool.GetSnapshot();
 
-    CTxMemPool::txiter it = mempool.mapTx.find(hash);
-    if (it == mempool.mapTx.end()) {
+    const CTxMemPoolSnapshotEntry* entry = snapshot->find(hash);
+    if (entry == nullptr) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not in mempool");
     }
 
-    CTxMemPool::setEntries setDescendants;
-    mempool.CalculateDescendants(it, setDescendants);
-    // CTxMemPool::CalculateDescendants will include the given tx
-    setDescendants.erase(it);
+    std::vector<const CTxMemPoolSnapshotEntry*> vDescendants;
+    snapshot->CalculateDescendants(*entry, vDescendants);
+    std::sort(vDescendants.begin(), vDescendants.end(), CompareSnapshotEntryByTxid);
 
     if (!fVerbose) {
         UniValue o(UniValue::VARR);
-        for (CTxMemPool::txiter descendantIt : setDescendants) {
-            o.push_back(descendantIt->GetTx().GetHash().ToString());
+        for (const CTxMemPoolSnapshotEntry* descendant : vDescendants) {
+            o.push_back(descendant->tx->GetHash().ToString());
         }
 
         return o;
     } else {
         UniValue o(UniValue::VOBJ);
-        for (CTxMemPool::txiter descendantIt : setDescendants) {
-            const CTxMemPoolEntry &e = *descendantIt;
-            const uint256& _hash = e.GetTx().GetHash();
-            UniValue info(UniValue::VOBJ);
-            entryToJSON(info, e);
-            o.push_back(Pair(_hash.ToString(), info));
+        for (const CTxMemPoolSnapshotEntry* descendant : vDescendants) {
+            o.push_back(Pair(descendant->tx->GetHash().ToString(), entryToJSON(*descendant)));
         }
         return o;
     }
@@ -734,17 +741,14 @@ UniValue getmempoolentry(const JSONRPCRequest& request)
 
     uint256 hash = ParseHashV(request.params[0], "parameter 1");
 
-    LOCK(mempool.cs);
+    CTxMemPoolSnapshotRef snapshot = mempool.GetSnapshot();
 
-    CTxMemPool::txiter it = mempool.mapTx.find(hash);
-    if (it == mempool.mapTx.end()) {
+    const CTxMemPoolSnapshotEntry* entry = snapshot->find(hash);
+    if (entry == nullptr) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not in mempool");
     }
 
-    const CTxMemPoolEntry &e = *it;
-    UniValue info(UniValue::VOBJ);
-    entryToJSON(info, e);
-    return info;
+    return entryToJSON(*entry);
 }
 
 UniValue getblockhash(const JSONRPCRequest& request)
@@ -1022,6 +1026,15 @@ UniValue getblock(const JSONRPCRequest& request)
     if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
         throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
 
+    if (verbosity <= 0)
+    {
+        // Hand out the stored bytes when they are in the requested encoding
+        CBlockView view;
+        if (ReadRawBlockFromDisk(view, pblockindex, Params().MessageStart()) &&
+            !(view.HasWitness() && (RPCSerializationFlags() & SERIALIZE_TRANSACTION_NO_WITNESS)))
+            return HexStr(view.GetRawBlock().begin(), view.GetRawBlock().end());
+    }
+
     if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
         // Block not found on disk. This could be because we have the block
         // header in our index but don't have the block (for example if a
@@ -1335,7 +1348,8 @@ UniValue waitforlogs(const JSONRPCRequest& request_) {
 
     WaitForLogsParams params(request.params);
 
-    request.PollStart();
+    if (!request.isLongPolling)
+        request.PollStart();
 
     std::vector<std::vector<uint256>> hashesToBlock;
 
@@ -1367,6 +1381,15 @@ UniValue waitforlogs(const JSONRPCRequest& request_) {
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
         }
 
+        // let the HTTP server call us again once a new block arrives
+        if (request.fCanPark) {
+            if (!request.PollAlive() || !IsRPCRunning()) {
+                LogPrintf("waitforlogs client disconnected\n");
+                return NullUniValue;
+            }
+            throw RPCLongPollPending{0, NullUniValue};
+        }
+
         // wait for a new block to arrive
         {
             while (true) {
@@ -1514,76 +1537,94 @@ UniValue searchlogs(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
 
     int curheight = 0;
-    
-    LOCK(cs_main);
 
-    SearchLogsParams params(request.params);
-    
-    std::vector<std::vector<uint256>> hashesToBlock;
+    auto hashesToBlock = std::make_shared<std::vector<std::vector<uint256>>>();
+    std::vector<boost::optional<dev::h256>> topics;
+    {
+        LOCK(cs_main);
 
-    curheight = pblocktree->ReadHeightIndex(params.fromBlock, params.toBlock, params.minconf, hashesToBlock, params.addresses);
+        SearchLogsParams params(request.params);
 
-    if (curheight == -1) {
-        throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
-    }
+        curheight = pblocktree->ReadHeightIndex(params.fromBlock, params.toBlock, params.minconf, *hashesToBlock, params.addresses);
 
-    UniValue result(UniValue::VARR);
+        if (curheight == -1) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
+        }
 
-    auto topics = params.topics;
+        topics = params.topics;
+    }
 
-    std::set<uint256> dupes;
+    // The receipts of indexed blocks are in the results database, so they can
+    // be read and written out without cs_main, one at a time.
+    auto writeLogs = [hashesToBlock, topics](const std::function<void(const UniValue&)>& push) {
+        std::set<uint256> dupes;
 
-    for(const auto& hashesTx : hashesToBlock)
-    {
-        for(const auto& e : hashesTx)
+        for(const auto& hashesTx : *hashesToBlock)
         {
+            for(const auto& e : hashesTx)
+            {
 
-            if(dupes.find(e) != dupes.end()) {
-                continue;
-            }
-            dupes.insert(e);
-
-            std::vector<TransactionReceiptInfo> receipts = pstorageresult->getResult(uintToh256(e));
-
-            for(const auto& receipt : receipts) {
-                if(receipt.logs.empty()) {
+                if(dupes.find(e) != dupes.end()) {
                     continue;
                 }
+                dupes.insert(e);
 
-                if (!topics.empty()) {
-                    for (size_t i = 0; i < topics.size(); i++) {
-                        const auto& tc = topics[i];
+                std::vector<TransactionReceiptInfo> receipts;
+                pstorageresult->getCommittedResult(uintToh256(e), receipts);
 
-                        if (!tc) {
-                            continue;
-                        }
+                for(const auto& receipt : receipts) {
+                    if(receipt.logs.empty()) {
+                        continue;
+                    }
 
-                        for (const auto& log: receipt.logs) {
-                            auto filterTopicContent = tc.get();
+                    if (!topics.empty()) {
+                        for (size_t i = 0; i < topics.size(); i++) {
+                            const auto& tc = topics[i];
 
-                            if (i >= log.topics.size()) {
+                            if (!tc) {
                                 continue;
                             }
 
-                            if (filterTopicContent == log.topics[i]) {
-                                goto push;
+                            for (const auto& log: receipt.logs) {
+                                auto filterTopicContent = tc.get();
+
+                                if (i >= log.topics.size()) {
+                                    continue;
+                                }
+
+                                if (filterTopicContent == log.topics[i]) {
+                                    goto push;
+                                }
                             }
                         }
-                    }
 
-                    // Skip the log if none of the topics are matched
-                    continue;
-                }
+                        // Skip the log if none of the topics are matched
+                        continue;
+                    }
 
-            push:
+                push:
 
-                UniValue tri(UniValue::VOBJ);
-                transactionReceiptInfoToJSON(receipt, tri);
-                result.push_back(tri);
+                    UniValue tri(UniValue::VOBJ);
+                    transactionReceiptInfoToJSON(receipt, tri);
+                    push(tri);
+                }
             }
         }
+    };
+
+    // Results over wide ranges can be huge, so stream them rather than
+    // building the whole array when the caller allows it.
+    if (request.fCanStream) {
+        throw RPCStreamResult{[writeLogs](JSONStreamWriter& writer) {
+            writer.BeginArray();
+            writeLogs([&writer](const UniValue& tri) { writer.Value(tri); });
+            writer.EndArray();
+        }};
     }
 
+    UniValue result(UniValue::VARR);
+    writeLogs([&result](const UniValue& tri) { result.push_back(tri); });
+
     return result;
 }
 
@@ -1675,6 +1716,7 @@ struct CCoinsStats
     uint64_t nTransactionOutputs;
     uint64_t nBogoSize;
     uint256 hashSerialized;
+    uint256 hashMuHash;
     uint64_t nDiskSize;
     CAmount nTotalAmount;
 
@@ -1693,14 +1735,13 @@ static void ApplyStats(CCoinsStats &stats, CHashWriter& ss, const uint256& hash,
         ss << VARINT(output.second.out.nValue);
         stats.nTransactionOutputs++;
         stats.nTotalAmount += output.second.out.nValue;
-        stats.nBogoSize += 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
-                           2 /* scriptPubKey len */ + output.second.out.scriptPubKey.size() /* scriptPubKey */;
+        stats.nBogoSize += GetBogoSize(output.second);
     }
     ss << VARINT(0);
 }
 
-//! Calculate statistics about the unspent transaction output set
-static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
+//! Calculate statistics about the unspent transaction output set, and its rolling hash if fMuHash
+static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats, bool fMuHash)
 {
     std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
     assert(pcursor);
@@ -1714,11 +1755,15 @@ static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
     ss << stats.hashBlock;
     uint256 prevkey;
     std::map<uint32_t, Coin> outputs;
+    MuHash3072 muhash;
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         COutPoint key;
         Coin coin;
         if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+            if (fMuHash) {
+                MuHashInsertCoin(muhash, key, coin);
+            }
             if (!outputs.empty() && key.hash != prevkey) {
                 ApplyStats(stats, ss, prevkey, outputs);
                 outputs.clear();
@@ -1734,6 +1779,9 @@ static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
         ApplyStats(stats, ss, prevkey, outputs);
     }
     stats.hashSerialized = ss.GetHash();
+    if (fMuHash) {
+        muhash.Finalize(stats.hashMuHash.begin());
+    }
     stats.nDiskSize = view->EstimateSize();
     return true;
 }
@@ -1789,38 +1837,99 @@ UniValue pruneblockchain(const JSONRPCRequest& request)
 
 UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 2)
         throw std::runtime_error(
-            "gettxoutsetinfo\n"
+            "gettxoutsetinfo ( \"hash_type\" hash_or_height )\n"
             "\nReturns statistics about the unspent transaction output set.\n"
-            "Note this call may take some time.\n"
+            "With -coinstatsindex, statistics other than the serialized hash are read from the index, for the tip\n"
+            "or any earlier block. Otherwise, or for the serialized hash, this call may take some time.\n"
+            "\nArguments:\n"
+            "1. \"hash_type\"      (string, optional) Which UTXO set hash to return: 'hash_serialized_2', 'muhash' or 'none'\n"
+            "                     (default: 'muhash' with -coinstatsindex, 'hash_serialized_2' otherwise)\n"
+            "2. hash_or_height   (string or numeric, optional) The hash or height of the block to return the statistics at,\n"
+            "                     the tip by default. Requires -coinstatsindex.\n"
             "\nResult:\n"
             "{\n"
             "  \"height\":n,     (numeric) The current block height (index)\n"
             "  \"bestblock\": \"hex\",   (string) the best block hash hex\n"
-            "  \"transactions\": n,      (numeric) The number of transactions\n"
+            "  \"transactions\": n,      (numeric) The number of transactions, not read from the index\n"
             "  \"txouts\": n,            (numeric) The number of output transactions\n"
             "  \"bogosize\": n,          (numeric) A meaningless metric for UTXO set size\n"
-            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash\n"
-            "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash, with hash_type 'hash_serialized_2'\n"
+            "  \"muhash\": \"hash\",      (string) The rolling hash of the set, with hash_type 'muhash'\n"
+            "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk, only for the tip\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "\"muhash\" 1000")
             + HelpExampleRpc("gettxoutsetinfo", "")
         );
 
+    std::string hashType = request.params[0].isNull() ? (pcoinstatsindex ? "muhash" : "hash_serialized_2") : request.params[0].get_str();
+    if (hashType != "hash_serialized_2" && hashType != "muhash" && hashType != "none") {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("%s is not a valid hash_type", hashType));
+    }
+    bool fUseIndex = pcoinstatsindex && hashType != "hash_serialized_2";
+
+    if (!request.params[1].isNull() && !fUseIndex) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Statistics at a given block require -coinstatsindex, and a hash_type other than hash_serialized_2");
+    }
+
     UniValue ret(UniValue::VOBJ);
 
+    if (fUseIndex) {
+        const CBlockIndex* pindex;
+        bool fTip;
+        {
+            LOCK(cs_main);
+            const UniValue& hashOrHeight = request.params[1];
+            int nHeight;
+            if (hashOrHeight.isNull()) {
+                pindex = chainActive.Tip();
+            } else if (hashOrHeight.isNum() || ParseInt32(hashOrHeight.get_str(), &nHeight)) {
+                if (hashOrHeight.isNum())
+                    nHeight = hashOrHeight.get_int();
+                if (nHeight < 0 || nHeight > chainActive.Height())
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
+                pindex = chainActive[nHeight];
+            } else {
+                uint256 hash = ParseHashV(hashOrHeight, "hash_or_height");
+                BlockMap::const_iterator it = mapBlockIndex.find(hash);
+                if (it == mapBlockIndex.end())
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+                pindex = it->second;
+            }
+            fTip = pindex == chainActive.Tip();
+        }
+
+        CCoinStatsEntry stats;
+        if (!pindex || !pcoinstatsindex->LookupStats(pindex->GetBlockHash(), stats))
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read the statistics of the block from the coin statistics index");
+        ret.push_back(Pair("height", (int64_t)stats.nHeight));
+        ret.push_back(Pair("bestblock", pindex->GetBlockHash().GetHex()));
+        ret.push_back(Pair("txouts", (int64_t)stats.nTransactionOutputs));
+        ret.push_back(Pair("bogosize", (int64_t)stats.nBogoSize));
+        if (hashType == "muhash")
+            ret.push_back(Pair("muhash", stats.hashMuHash.GetHex()));
+        if (fTip)
+            ret.push_back(Pair("disk_size", pcoinsdbview->EstimateSize()));
+        ret.push_back(Pair("total_amount", ValueFromAmount(stats.nTotalAmount)));
+        return ret;
+    }
+
     CCoinsStats stats;
     FlushStateToDisk();
-    if (GetUTXOStats(pcoinsdbview.get(), stats)) {
+    if (GetUTXOStats(pcoinsdbview.get(), stats, hashType == "muhash")) {
         ret.push_back(Pair("height", (int64_t)stats.nHeight));
         ret.push_back(Pair("bestblock", stats.hashBlock.GetHex()));
         ret.push_back(Pair("transactions", (int64_t)stats.nTransactions));
         ret.push_back(Pair("txouts", (int64_t)stats.nTransactionOutputs));
         ret.push_back(Pair("bogosize", (int64_t)stats.nBogoSize));
-        ret.push_back(Pair("hash_serialized_2", stats.hashSerialized.GetHex()));
+        if (hashType == "hash_serialized_2")
+            ret.push_back(Pair("hash_serialized_2", stats.hashSerialized.GetHex()));
+        if (hashType == "muhash")
+            ret.push_back(Pair("muhash", stats.hashMuHash.GetHex()));
         ret.push_back(Pair("disk_size", stats.nDiskSize));
         ret.push_back(Pair("total_amount", ValueFromAmount(stats.nTotalAmount)));
     } else {
@@ -2496,7 +2605,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type","hash_or_height"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
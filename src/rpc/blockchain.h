@@ -8,6 +8,8 @@
 class CBlock;
 class CBlockIndex;
 class UniValue;
+struct TransactionReceiptInfo;
+namespace dev { namespace eth { struct LogEntry; } }
 
 /**
  * Get the difficulty of the net wrt to the given block index, or the chain tip if
@@ -33,5 +35,11 @@ UniValue mempoolToJSON(bool fVerbose = false);
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* blockindex);
 
+/** Contract transaction receipt to JSON */
+void transactionReceiptInfoToJSON(const TransactionReceiptInfo& resExec, UniValue& entry);
+
+/** Contract log entry to JSON */
+void assignJSON(UniValue& logEntry, const dev::eth::LogEntry& log, bool includeAddress);
+
 #endif
 
@@ -50,6 +50,102 @@ std::string JSONRPCReply(const UniValue& result, const UniValue& error, const Un
     return reply.write() + "\n";
 }
 
+JSONStreamWriter::JSONStreamWriter(const Sink& sinkIn, size_t nChunkSizeIn) : sink(sinkIn), nChunkSize(nChunkSizeIn), fAfterKey(false)
+{
+}
+
+void JSONStreamWriter::Separator()
+{
+    if (fAfterKey) {
+        fAfterKey = false;
+    } else if (!vFirst.empty()) {
+        if (!vFirst.back())
+            Raw(",");
+        vFirst.back() = false;
+    }
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    Separator();
+    Raw("[");
+    vFirst.push_back(true);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!vFirst.empty() && !fAfterKey);
+    vFirst.pop_back();
+    Raw("]");
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    Separator();
+    Raw("{");
+    vFirst.push_back(true);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!vFirst.empty() && !fAfterKey);
+    vFirst.pop_back();
+    Raw("}");
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    Separator();
+    // UniValue escapes the key exactly as it does in objects
+    Raw(UniValue(key).write());
+    Raw(":");
+    fAfterKey = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& val)
+{
+    if (val.isObject()) {
+        BeginObject();
+        const std::vector<std::string>& keys = val.getKeys();
+        const std::vector<UniValue>& values = val.getValues();
+        for (size_t i = 0; i < keys.size(); i++) {
+            Key(keys[i]);
+            Value(values[i]);
+        }
+        EndObject();
+    } else if (val.isArray()) {
+        BeginArray();
+        for (const UniValue& v : val.getValues())
+            Value(v);
+        EndArray();
+    } else {
+        Separator();
+        Raw(val.write());
+    }
+}
+
+void JSONStreamWriter::Raw(const std::string& str)
+{
+    buffer += str;
+    if (buffer.size() >= nChunkSize)
+        Flush();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (buffer.empty())
+        return;
+    sink(buffer);
+    buffer.clear();
+}
+
+std::string JSONStreamWriter::TakeBuffer()
+{
+    std::string ret;
+    ret.swap(buffer);
+    return ret;
+}
+
 UniValue JSONRPCError(int code, const std::string& message)
 {
     UniValue error(UniValue::VOBJ);
@@ -8,10 +8,12 @@
 
 #include <fs.h>
 
+#include <functional>
 #include <list>
 #include <map>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include <univalue.h>
 
@@ -19,6 +21,7 @@
 enum HTTPStatusCode
 {
     HTTP_OK                    = 200,
+    HTTP_NOT_MODIFIED          = 304,
     HTTP_BAD_REQUEST           = 400,
     HTTP_UNAUTHORIZED          = 401,
     HTTP_FORBIDDEN             = 403,
@@ -92,6 +95,48 @@ UniValue JSONRPCReplyObj(const UniValue& result, const UniValue& error, const Un
 std::string JSONRPCReply(const UniValue& result, const UniValue& error, const UniValue& id);
 UniValue JSONRPCError(int code, const std::string& message);
 
+/**
+ * Writes the same JSON as UniValue::write(), but hands it to a sink in pieces
+ * of about nChunkSize bytes as they fill up instead of building one string.
+ * Values are written whole, or arrays and objects are opened and closed around
+ * their members so that large results never have to exist as a UniValue.
+ */
+class JSONStreamWriter
+{
+public:
+    typedef std::function<void(const std::string&)> Sink;
+
+    static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    explicit JSONStreamWriter(const Sink& sinkIn, size_t nChunkSizeIn = DEFAULT_CHUNK_SIZE);
+
+    void BeginArray();
+    void EndArray();
+    void BeginObject();
+    void EndObject();
+    /** Start an object member, the next value written is its value */
+    void Key(const std::string& key);
+    void Value(const UniValue& val);
+    /** Append text as is, e.g. a line break after the top-level value */
+    void Raw(const std::string& str);
+
+    /** Hand everything written so far to the sink */
+    void Flush();
+    /** Return what has not been handed to the sink yet and forget it */
+    std::string TakeBuffer();
+
+private:
+    void Separator();
+
+    Sink sink;
+    size_t nChunkSize;
+    std::string buffer;
+    //! Whether the next member of each open array or object is its first
+    std::vector<bool> vFirst;
+    bool fAfterKey;
+};
+
+
 /** Generate a new RPC authentication cookie and write it to disk */
 bool GenerateAuthCookie(std::string *cookie_out);
 /** Read the RPC authentication cookie from disk */
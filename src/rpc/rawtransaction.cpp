@@ -495,9 +495,9 @@ UniValue createrawtransaction(const JSONRPCRequest& request)
 
             // Get dgp gas limit and gas price
             LOCK(cs_main);
-            AbpDGP abpDGP(globalState.get(), fGettingValuesDGP);
-            uint64_t blockGasLimit = abpDGP.getBlockGasLimit(chainActive.Height());
-            uint64_t minGasPrice = CAmount(abpDGP.getMinGasPrice(chainActive.Height()));
+            DGPParams dgpParams = GetEVMTipContext()->GetDGPParams(chainActive.Height());
+            uint64_t blockGasLimit = dgpParams.blockGasLimit;
+            uint64_t minGasPrice = CAmount(dgpParams.minGasPrice);
             CAmount nGasPrice = (minGasPrice>DEFAULT_GAS_PRICE)?minGasPrice:DEFAULT_GAS_PRICE;
 
             // Get the contract address
@@ -20,7 +20,11 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
+#include <array>
+#include <deque>
 #include <memory> // for unique_ptr
+#include <set>
+#include <thread>
 #include <unordered_map>
 
 static bool fRPCRunning = false;
@@ -32,6 +36,39 @@ static RPCTimerInterface* timerInterface = nullptr;
 /* Map of name to timer. */
 static std::map<std::string, std::unique_ptr<RPCTimerBase> > deadlineTimers;
 
+/** Number of buckets of the per-method latency histogram */
+static const size_t RPC_LATENCY_HISTOGRAM_BUCKETS = 18;
+
+/** Call counters of one RPC method */
+struct RPCMethodStats
+{
+    uint64_t nCalls = 0;
+    uint64_t nErrors = 0;
+    int64_t nTotalMicros = 0;
+    int64_t nMaxMicros = 0;
+    //! Bucket i counts calls that took [2^(i-1), 2^i) milliseconds
+    std::array<uint64_t, RPC_LATENCY_HISTOGRAM_BUCKETS> vLatency{};
+};
+
+static CCriticalSection cs_rpcStats;
+static std::map<std::string, RPCMethodStats> mapRPCStats;
+
+static void RecordRPCCall(const std::string& method, int64_t nMicros, bool fError)
+{
+    size_t bucket = 0;
+    while (bucket + 1 < RPC_LATENCY_HISTOGRAM_BUCKETS && ((nMicros / 1000) >> bucket) != 0)
+        bucket++;
+
+    LOCK(cs_rpcStats);
+    RPCMethodStats& stats = mapRPCStats[method];
+    stats.nCalls++;
+    if (fError)
+        stats.nErrors++;
+    stats.nTotalMicros += nMicros;
+    stats.nMaxMicros = std::max(stats.nMaxMicros, nMicros);
+    stats.vLatency[bucket]++;
+}
+
 static struct CRPCSignals
 {
     boost::signals2::signal<void ()> Started;
@@ -49,6 +86,93 @@ void RPCServer::OnStopped(std::function<void ()> slot)
     g_rpcSignals.Stopped.connect(slot);
 }
 
+/** Methods that only read, so that the entries of a batch calling them may
+ * run at the same time without changing what any of them sees.
+ */
+static const std::set<std::string> setRPCBatchParallel = {
+    "getbestblockhash",
+    "getblock",
+    "getblockchaininfo",
+    "getblockcount",
+    "getblockhash",
+    "getblockheader",
+    "getchaintips",
+    "getdifficulty",
+    "getmempoolentry",
+    "getrawmempool",
+    "getrawtransaction",
+    "gettxout",
+    "decoderawtransaction",
+    "gettransactionreceipt",
+    "callcontract",
+    "getaccountinfo",
+    "getstorage",
+    "listcontracts",
+    "searchlogs",
+};
+
+/** Threads running the read-only entries of JSON-RPC batches */
+class RPCBatchQueue
+{
+public:
+    void Start(int nThreads)
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        fRunning = true;
+        for (int i = 0; i < nThreads; i++)
+            threads.emplace_back(&RPCBatchQueue::Run, this);
+    }
+
+    /** Let the threads finish what is queued and join them */
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            fRunning = false;
+        }
+        cond.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+        threads.clear();
+    }
+
+    /** Queue task, or return false if there are no threads to run it */
+    bool Enqueue(const std::function<void()>& task)
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        if (!fRunning || threads.empty())
+            return false;
+        queue.push_back(task);
+        cond.notify_one();
+        return true;
+    }
+
+private:
+    void Run()
+    {
+        RenameThread("abp-rpcbatch");
+        std::unique_lock<std::mutex> lock(cs);
+        while (true) {
+            cond.wait(lock, [this] { return !fRunning || !queue.empty(); });
+            if (queue.empty())
+                return;
+            std::function<void()> task = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex cs;
+    std::condition_variable cond;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::thread> threads;
+    bool fRunning = false;
+};
+
+static RPCBatchQueue rpcBatchQueue;
+
 void RPCTypeCheck(const UniValue& params,
                   const std::list<UniValue::VType>& typesExpected,
                   bool fAllowNull)
@@ -256,6 +380,82 @@ UniValue uptime(const JSONRPCRequest& jsonRequest)
     return GetTime() - GetStartupTime();
 }
 
+UniValue getrpcstats(const JSONRPCRequest& jsonRequest)
+{
+    if (jsonRequest.fHelp || jsonRequest.params.size() > 0)
+        throw std::runtime_error(
+                "getrpcstats\n"
+                        "\nReturns per-method call statistics and the state of the HTTP work queues.\n"
+                        "\nResult:\n"
+                        "{\n"
+                        "  \"methods\": {                   (json object) Keyed by method name\n"
+                        "    \"name\": {\n"
+                        "      \"calls\": n,                 (numeric) Number of calls, long-poll calls count once per run\n"
+                        "      \"errors\": n,                (numeric) Number of calls that failed\n"
+                        "      \"total_ms\": n,              (numeric) Total time spent in the method\n"
+                        "      \"max_ms\": n,                (numeric) Longest call\n"
+                        "      \"latency_ms\": [n,...]       (array) Calls that took less than 1, 2, 4, ... milliseconds, the last bucket is open-ended\n"
+                        "    }, ...\n"
+                        "  },\n"
+                        "  \"queues\": [                    (array) HTTP work queues\n"
+                        "    {\n"
+                        "      \"name\": \"str\",              (string) default, longpoll, contract or tx\n"
+                        "      \"threads\": n,               (numeric) Worker threads\n"
+                        "      \"depth\": n,                 (numeric) Requests waiting\n"
+                        "      \"maxdepth\": n,              (numeric) Configured depth\n"
+                        "      \"peakdepth\": n,             (numeric) Highest depth seen\n"
+                        "      \"rejected\": n,              (numeric) Requests rejected because the queue was full\n"
+                        "      \"depth_histogram\": [n,...]  (array) Depth seen by enqueued requests: 0, then less than 2, 4, 8, ...\n"
+                        "    }, ...\n"
+                        "  ],\n"
+                        "  \"parked\": n                    (numeric) Long-poll requests parked without a thread\n"
+                        "}\n"
+                        "\nExamples:\n"
+                + HelpExampleCli("getrpcstats", "")
+                + HelpExampleRpc("getrpcstats", "")
+        );
+
+    UniValue methods(UniValue::VOBJ);
+    {
+        LOCK(cs_rpcStats);
+        for (const auto& item : mapRPCStats) {
+            const RPCMethodStats& stats = item.second;
+            UniValue latency(UniValue::VARR);
+            for (uint64_t n : stats.vLatency)
+                latency.push_back(n);
+            UniValue method(UniValue::VOBJ);
+            method.push_back(Pair("calls", stats.nCalls));
+            method.push_back(Pair("errors", stats.nErrors));
+            method.push_back(Pair("total_ms", stats.nTotalMicros / 1000));
+            method.push_back(Pair("max_ms", stats.nMaxMicros / 1000));
+            method.push_back(Pair("latency_ms", latency));
+            methods.push_back(Pair(item.first, method));
+        }
+    }
+
+    UniValue queues(UniValue::VARR);
+    for (const HTTPWorkQueueStats& stats : GetHTTPWorkQueueStats()) {
+        UniValue histogram(UniValue::VARR);
+        for (uint64_t n : stats.vDepthHistogram)
+            histogram.push_back(n);
+        UniValue queue(UniValue::VOBJ);
+        queue.push_back(Pair("name", stats.name));
+        queue.push_back(Pair("threads", stats.nThreads));
+        queue.push_back(Pair("depth", (uint64_t)stats.nDepth));
+        queue.push_back(Pair("maxdepth", (uint64_t)stats.nMaxDepth));
+        queue.push_back(Pair("peakdepth", (uint64_t)stats.nPeakDepth));
+        queue.push_back(Pair("rejected", stats.nRejected));
+        queue.push_back(Pair("depth_histogram", histogram));
+        queues.push_back(queue);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("methods", methods));
+    ret.push_back(Pair("queues", queues));
+    ret.push_back(Pair("parked", (uint64_t)GetParkedHTTPRequestCount()));
+    return ret;
+}
+
 /**
  * Call Table
  */
@@ -266,6 +466,7 @@ static const CRPCCommand vRPCCommands[] =
     { "control",            "help",                   &help,                   {"command"}  },
     { "control",            "stop",                   &stop,                   {}  },
     { "control",            "uptime",                 &uptime,                 {}  },
+    { "control",            "getrpcstats",            &getrpcstats,            {}  },
 };
 
 CRPCTable::CRPCTable()
@@ -306,6 +507,7 @@ bool StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
     fRPCRunning = true;
+    rpcBatchQueue.Start(std::max<int>(gArgs.GetArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 0));
     g_rpcSignals.Started();
     return true;
 }
@@ -320,6 +522,7 @@ void InterruptRPC()
 void StopRPC()
 {
     LogPrint(BCLog::RPC, "Stopping RPC\n");
+    rpcBatchQueue.Stop();
     deadlineTimers.clear();
     DeleteAuthCookie();
     g_rpcSignals.Stopped();
@@ -449,13 +652,63 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
-std::string JSONRPCExecBatch(JSONRPCRequest jreq, const UniValue& vReq)
+static bool IsRPCBatchParallel(const UniValue& req)
+{
+    if (!req.isObject())
+        return false;
+    const UniValue& method = find_value(req, "method");
+    return method.isStr() && setRPCBatchParallel.count(method.get_str());
+}
+
+/** Replies to the entries of a batch, filled in by the batch threads */
+struct RPCBatchReplies
 {
-    UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    std::mutex cs;
+    std::condition_variable cond;
+    std::vector<UniValue> replies;
+    std::vector<bool> vDone;
+};
+
+void JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, JSONStreamWriter& writer)
+{
+    const size_t nParallel = std::max<int64_t>(gArgs.GetArg("-rpcbatchparallel", DEFAULT_RPC_BATCH_PARALLEL), 1);
+    std::shared_ptr<RPCBatchReplies> batch = std::make_shared<RPCBatchReplies>();
+    batch->replies.resize(vReq.size());
+    batch->vDone.resize(vReq.size());
+
+    writer.BeginArray();
+    size_t nQueued = 0;
+    for (size_t i = 0; i < vReq.size(); i++) {
+        // Keep the read-only entries from i on running, up to the next other one
+        for (; nQueued < vReq.size() && nQueued < i + nParallel && IsRPCBatchParallel(vReq[nQueued]); nQueued++) {
+            size_t n = nQueued;
+            UniValue req = vReq[n];
+            bool fQueued = rpcBatchQueue.Enqueue([batch, jreq, req, n] {
+                UniValue reply = JSONRPCExecOne(jreq, req);
+                std::lock_guard<std::mutex> lock(batch->cs);
+                batch->replies[n] = std::move(reply);
+                batch->vDone[n] = true;
+                batch->cond.notify_all();
+            });
+            if (!fQueued)
+                break;
+        }
 
-    return ret.write() + "\n";
+        if (i < nQueued) {
+            UniValue reply;
+            {
+                std::unique_lock<std::mutex> lock(batch->cs);
+                batch->cond.wait(lock, [&batch, i] { return batch->vDone[i]; });
+                reply = std::move(batch->replies[i]);
+            }
+            writer.Value(reply);
+        } else {
+            // Everything before it is done, it runs alone
+            writer.Value(JSONRPCExecOne(jreq, vReq[i]));
+            nQueued = i + 1;
+        }
+    }
+    writer.EndArray();
 }
 
 /**
@@ -524,19 +777,39 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 
     g_rpcSignals.PreCommand(*pcmd);
 
+    int64_t nTimeStart = GetTimeMicros();
     try
     {
         // Execute, convert arguments to array if necessary
+        UniValue result;
         if (request.params.isObject()) {
-            return pcmd->actor(transformNamedArguments(request, pcmd->argNames));
+            result = pcmd->actor(transformNamedArguments(request, pcmd->argNames));
         } else {
-            return pcmd->actor(request);
+            result = pcmd->actor(request);
         }
+        RecordRPCCall(request.strMethod, GetTimeMicros() - nTimeStart, false);
+        return result;
+    }
+    catch (const RPCLongPollPending&)
+    {
+        RecordRPCCall(request.strMethod, GetTimeMicros() - nTimeStart, false);
+        throw;
+    }
+    catch (const RPCStreamResult&)
+    {
+        RecordRPCCall(request.strMethod, GetTimeMicros() - nTimeStart, false);
+        throw;
     }
     catch (const std::exception& e)
     {
+        RecordRPCCall(request.strMethod, GetTimeMicros() - nTimeStart, true);
         throw JSONRPCError(RPC_MISC_ERROR, e.what());
     }
+    catch (...)
+    {
+        RecordRPCCall(request.strMethod, GetTimeMicros() - nTimeStart, true);
+        throw;
+    }
 }
 
 std::vector<std::string> CRPCTable::listCommands() const
@@ -21,6 +21,8 @@
 #include <condition_variable>
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
+static const int DEFAULT_RPC_BATCH_THREADS = 4;
+static const int DEFAULT_RPC_BATCH_PARALLEL = 4;
 
 struct CUpdatedBlock
 {
@@ -61,6 +63,16 @@ public:
 
     bool isLongPolling;
 
+    /**
+     * Whether a long-poll method may throw RPCLongPollPending instead of
+     * blocking. pollState is what it passed along with the last throw.
+     */
+    bool fCanPark;
+    UniValue pollState;
+
+    /** Whether a method may throw RPCStreamResult instead of returning */
+    bool fCanStream;
+
     /**
      * If using batch JSON request, this object won't get the underlying HTTPRequest.
      */
@@ -70,6 +82,8 @@ public:
         fHelp = false;
         req = NULL;
         isLongPolling = false;
+        fCanPark = false;
+        fCanStream = false;
     };
 
     JSONRPCRequest(HTTPRequest *_req);
@@ -105,6 +119,29 @@ public:
     HTTPRequest *req;
 };
 
+/**
+ * Thrown by a long-poll method that has nothing to return yet while
+ * request.fCanPark is set. The HTTP server parks the request without holding
+ * a worker thread and calls the method again, with pollState set to state,
+ * after the next block tip change, at nDeadline (GetTimeMillis(), 0 for none)
+ * or when the client disconnects.
+ */
+struct RPCLongPollPending
+{
+    int64_t nDeadline;
+    UniValue state;
+};
+
+/**
+ * Thrown by a method whose result is too large to build as a UniValue, while
+ * request.fCanStream is set. Once the method has returned (and released its
+ * locks) the HTTP server calls write to emit the result into the reply.
+ */
+struct RPCStreamResult
+{
+    std::function<void(JSONStreamWriter&)> write;
+};
+
 /** Query whether RPC is running */
 bool IsRPCRunning();
 
@@ -248,7 +285,14 @@ extern std::string HelpExampleRpc(const std::string& methodname, const std::stri
 bool StartRPC();
 void InterruptRPC();
 void StopRPC();
-std::string JSONRPCExecBatch(JSONRPCRequest jreq, const UniValue& vReq);
+/**
+ * Execute a batch of JSON-RPC requests and write the array of their replies
+ * in order, each as soon as it and the ones before it are done. Read-only
+ * requests run on the -rpcbatchthreads threads, at most -rpcbatchparallel of
+ * one batch at a time. Any other request waits for the ones before it and
+ * runs alone.
+ */
+void JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, JSONStreamWriter& writer);
 
 // Retrieves any serialization flags requested in command line argument
 int RPCSerializationFlags();
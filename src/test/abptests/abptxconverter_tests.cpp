@@ -166,4 +166,44 @@ BOOST_AUTO_TEST_CASE(parse_incorrect_txcall_overflow){
     runFailingTest(false, 120, script1, script2);
 }
 
+BOOST_AUTO_TEST_CASE(parse_memoized){
+    mempool.clear();
+    TestMemPoolEntryHelper entry;
+    CMutableTransaction tx1 = createTX({CTxOut(value, CScript() << OP_DUP << OP_HASH160 << address << OP_EQUALVERIFY << OP_CHECKSIG)});
+    CScript script = CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(int64_t(gasLimit)) << CScriptNum(int64_t(gasPrice)) << data << address << OP_CALL;
+    CTransaction transaction(createTX({CTxOut(value, script), CTxOut(value, script)}, tx1.GetHash()));
+    BOOST_CHECK(transaction.HasCreateOrCall());
+    BOOST_CHECK(!transaction.HasOpSpend());
+    BOOST_CHECK(!transaction.GetContractOutputs());
+
+    // The sender can not be found yet, the parse is kept without it
+    ExtractAbpTX abpTx;
+    BOOST_CHECK(AbpTxConverter(transaction, NULL).extractionAbpTransactions(abpTx));
+    std::shared_ptr<const ContractOutputs> outputs = transaction.GetContractOutputs();
+    BOOST_REQUIRE(outputs);
+    BOOST_CHECK(outputs->valid && outputs->params.size() == 2);
+    BOOST_CHECK(outputs->sender == dev::Address());
+
+    mempool.addUnchecked(tx1.GetHash(), entry.Fee(1000).Time(GetTime()).SpendsCoinbase(true).FromTx(tx1));
+    BOOST_CHECK(AbpTxConverter(transaction, NULL).extractionAbpTransactions(abpTx));
+    BOOST_CHECK(transaction.GetContractOutputs()->sender == dev::Address(address));
+    BOOST_CHECK(transaction.GetContractOutputs()->params.size() == 2);
+    checkResult(false, abpTx.first, transaction.GetHash());
+
+    // Copies share the parse and the resolved sender
+    mempool.clear();
+    CTransaction copy(transaction);
+    BOOST_CHECK(copy.GetContractOutputs() == transaction.GetContractOutputs());
+    BOOST_CHECK(AbpTxConverter(copy, NULL).extractionAbpTransactions(abpTx));
+    checkResult(false, abpTx.first, transaction.GetHash());
+
+    // A malformed transaction is remembered as such
+    CScript bad = CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(int64_t(gasLimit)) << CScriptNum(int64_t(gasPrice)) << data << OP_CALL;
+    CTransaction badTransaction(createTX({CTxOut(value, script), CTxOut(value, bad)}, tx1.GetHash()));
+    BOOST_CHECK(!AbpTxConverter(badTransaction, NULL).extractionAbpTransactions(abpTx));
+    BOOST_REQUIRE(badTransaction.GetContractOutputs());
+    BOOST_CHECK(!badTransaction.GetContractOutputs()->valid);
+    BOOST_CHECK(!AbpTxConverter(badTransaction, NULL).extractionAbpTransactions(abpTx));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
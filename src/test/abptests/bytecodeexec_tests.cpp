@@ -374,4 +374,27 @@ BOOST_AUTO_TEST_CASE(bytecodeexec_contract_create_contracts){
     BOOST_CHECK(result.second.valueTransfers.size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(bytecodeexec_tip_context){
+    initState();
+    std::shared_ptr<const EVMTipContext> context = GetEVMTipContext();
+    BOOST_CHECK(context == GetEVMTipContext());
+    BOOST_CHECK(context->GetTipHash() == chainActive.Tip()->GetBlockHash());
+    BOOST_CHECK_EQUAL(context->GetTipHeight(), chainActive.Height());
+    BOOST_REQUIRE_EQUAL(context->GetLastHashes()->size(), 256U);
+    BOOST_CHECK((*context->GetLastHashes())[0] == uintToh256(chainActive.Tip()->GetBlockHash()));
+    BOOST_CHECK((*context->GetLastHashes())[1] == dev::h256());
+
+    // The environment of every execution shares the hashes instead of copying them
+    dev::eth::EnvInfo env;
+    env.setLastHashes(context->GetLastHashes());
+    BOOST_CHECK(&env.lastHashes() == context->GetLastHashes().get());
+
+    // Memoized or not, the DGP values are what a direct read of the state gives
+    AbpDGP abpDGP(globalState.get(), fGettingValuesDGP);
+    DGPParams params = context->GetDGPParams(chainActive.Height() + 1);
+    BOOST_CHECK_EQUAL(params.blockGasLimit, abpDGP.getBlockGasLimit(chainActive.Height() + 1));
+    BOOST_CHECK_EQUAL(params.minGasPrice, abpDGP.getMinGasPrice(chainActive.Height() + 1));
+    BOOST_CHECK_EQUAL(params.blockSize, abpDGP.getBlockSize(chainActive.Height() + 1));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
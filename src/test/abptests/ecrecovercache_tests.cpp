@@ -0,0 +1,102 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <abp/ecrecovercache.h>
+#include <cuckoocache.h>
+#include <random.h>
+#include <libdevcrypto/Common.h>
+#include <libethcore/Precompiled.h>
+
+namespace ecrecoverCacheTest{
+
+dev::bytes ecrecoverInput(const dev::h256& hash, const dev::Signature& sig)
+{
+    dev::SignatureStruct s(sig);
+    dev::bytes in(128, 0);
+    memcpy(in.data(), hash.data(), 32);
+    in[63] = s.v + 27;
+    memcpy(in.data() + 64, s.r.data(), 32);
+    memcpy(in.data() + 96, s.s.data(), 32);
+    return in;
+}
+
+dev::bytes ecrecover(const dev::bytes& in)
+{
+    std::pair<bool, dev::bytes> ret = dev::eth::PrecompiledRegistrar::executor("ecrecover")(dev::bytesConstRef(&in));
+    BOOST_CHECK(ret.first);
+    return ret.second;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(ecrecovercache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(ecrecovercache_get_returns_payload){
+    CuckooCache::cache<EcrecoverCacheEntry, EcrecoverCacheHasher> cache;
+    cache.setup_bytes(1 << 16);
+
+    EcrecoverCacheEntry entry;
+    entry.key = InsecureRand256();
+    entry.output = InsecureRand256();
+    entry.recovered = true;
+    cache.insert(entry);
+
+    EcrecoverCacheEntry lookup;
+    lookup.key = entry.key;
+    BOOST_CHECK(cache.get(lookup, false));
+    BOOST_CHECK(lookup.output == entry.output);
+    BOOST_CHECK(lookup.recovered);
+
+    EcrecoverCacheEntry missing;
+    missing.key = InsecureRand256();
+    BOOST_CHECK(!cache.get(missing, false));
+    BOOST_CHECK(missing.output.IsNull());
+}
+
+BOOST_AUTO_TEST_CASE(ecrecovercache_precompile){
+    dev::Secret secret(dev::sha3(std::string("ecrecovercache_tests")));
+    dev::h256 expected(dev::toAddress(secret), dev::h256::AlignRight);
+
+    for (int i = 0; i < 3; ++i) {
+        dev::h256 hash(InsecureRand256().GetHex());
+        dev::bytes in = ecrecoverCacheTest::ecrecoverInput(hash, dev::sign(secret, hash));
+
+        // Miss, then hit.
+        BOOST_CHECK(ecrecoverCacheTest::ecrecover(in) == expected.asBytes());
+        BOOST_CHECK(ecrecoverCacheTest::ecrecover(in) == expected.asBytes());
+
+        // A different hash with the same signature must not be served from the cache.
+        dev::bytes other = in;
+        other[0] ^= 1;
+        BOOST_CHECK(ecrecoverCacheTest::ecrecover(other) != expected.asBytes());
+
+        // Invalid v recovers nothing, both before and after caching the failure.
+        dev::bytes invalid = in;
+        invalid[63] = 29;
+        BOOST_CHECK(ecrecoverCacheTest::ecrecover(invalid).empty());
+        BOOST_CHECK(ecrecoverCacheTest::ecrecover(invalid).empty());
+    }
+
+    // Short inputs are padded the same way as the uncached precompile.
+    dev::bytes shortIn(64, 0);
+    BOOST_CHECK(ecrecoverCacheTest::ecrecover(shortIn).empty());
+}
+
+BOOST_AUTO_TEST_CASE(ecrecovercache_schedule_change){
+    dev::Secret secret(dev::sha3(std::string("ecrecovercache_schedule")));
+    dev::h256 expected(dev::toAddress(secret), dev::h256::AlignRight);
+    dev::h256 hash(InsecureRand256().GetHex());
+    dev::bytes in = ecrecoverCacheTest::ecrecoverInput(hash, dev::sign(secret, hash));
+
+    dev::eth::EVMSchedule schedule;
+    UpdateEcrecoverCacheSchedule(schedule);
+    BOOST_CHECK(ecrecoverCacheTest::ecrecover(in) == expected.asBytes());
+
+    schedule.sstoreSetGas += 1;
+    UpdateEcrecoverCacheSchedule(schedule);
+    BOOST_CHECK(ecrecoverCacheTest::ecrecover(in) == expected.asBytes());
+
+    ClearEcrecoverCache();
+    BOOST_CHECK(ecrecoverCacheTest::ecrecover(in) == expected.asBytes());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <libdevcore/CommonData.h>
+#include <libevm/ExtVMFace.h>
+#include <libevm/VMFactory.h>
+#include <libevm/VMFrame.h>
+
+namespace evmDispatchTest{
+
+class TestExtVM : public dev::eth::ExtVMFace
+{
+public:
+    TestExtVM(const dev::eth::EnvInfo& envInfo, const dev::bytes& code)
+        : ExtVMFace(envInfo, dev::Address(), dev::Address(), dev::Address(), 0, 1, dev::bytesConstRef(), code, dev::sha3(code), 0) {}
+
+    boost::optional<dev::eth::owning_bytes_ref> call(dev::eth::CallParameters&) override { return boost::none; }
+};
+
+dev::bytes exec(const std::string& code, dev::u256& gas){
+    dev::eth::EnvInfo envInfo;
+    TestExtVM ext(envInfo, dev::fromHex(code));
+    std::unique_ptr<dev::eth::VMFace> vm = dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter);
+    return vm->exec(gas, ext, dev::eth::OnOpFunc()).toBytes();
+}
+
+// PUSH2 0x0400 JUMPDEST PUSH1 1 SWAP1 SUB DUP1 PUSH1 3 JUMPI STOP
+const std::string LOOP = "6104005b6001900380600357" "00";
+const dev::u256 LOOP_GAS = 3 + 1024 * (1 + 3 + 3 + 3 + 3 + 3 + 10);
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(evmdispatch_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(evmdispatch_block_gas){
+    dev::u256 gas = evmDispatchTest::LOOP_GAS + 100;
+    evmDispatchTest::exec(evmDispatchTest::LOOP, gas);
+    BOOST_CHECK(gas == 100);
+
+    // Out of gas in the last iteration's block, which then runs checked
+    gas = evmDispatchTest::LOOP_GAS - 1;
+    BOOST_CHECK_THROW(evmDispatchTest::exec(evmDispatchTest::LOOP, gas), dev::eth::OutOfGas);
+
+    // GAS sees what is left after each instruction before it in its block:
+    // PUSH1 0 POP GAS PUSH1 0 MSTORE PUSH1 32 PUSH1 0 RETURN
+    gas = 1000;
+    dev::bytes out = evmDispatchTest::exec("6000505a600052" "60206000f3", gas);
+    BOOST_REQUIRE_EQUAL(out.size(), 32U);
+    BOOST_CHECK_EQUAL(dev::fromBigEndian<dev::u256>(out), 1000 - 3 - 2 - 2);
+}
+
+BOOST_AUTO_TEST_CASE(evmdispatch_exception_order){
+    // PUSH1 1 POP POP STOP: the second POP underflows before the block's gas
+    // runs out, as it would with gas checked per instruction
+    dev::u256 gas = 5;
+    BOOST_CHECK_THROW(evmDispatchTest::exec("60015050" "00", gas), dev::eth::StackUnderflow);
+    gas = 4;
+    BOOST_CHECK_THROW(evmDispatchTest::exec("60015050" "00", gas), dev::eth::OutOfGas);
+
+    // A jump into the middle of a block is still a bad jump destination:
+    // PUSH1 4 JUMP PUSH1 0x5b STOP
+    gas = 1000;
+    BOOST_CHECK_THROW(evmDispatchTest::exec("600456605b" "00", gas), dev::eth::BadJumpDestination);
+
+    // Stack overflow inside a block that fits the gas: 1025 x PUSH1 0
+    std::string push;
+    for(int i = 0; i < 1025; i++)
+        push += "6000";
+    gas = 100000;
+    BOOST_CHECK_THROW(evmDispatchTest::exec(push, gas), dev::eth::OutOfStack);
+}
+
+BOOST_AUTO_TEST_CASE(evmdispatch_frame_reuse){
+    // PUSH1 42 PUSH2 0x1000 MSTORE PUSH1 32 PUSH2 0x1000 RETURN
+    dev::u256 gas = 100000;
+    dev::bytes out = evmDispatchTest::exec("602a611000526020611000f3", gas);
+    BOOST_CHECK_EQUAL(dev::fromBigEndian<dev::u256>(out), 42);
+
+    // The next transaction gets the same arena and frame space, its memory
+    // still starts out zero: PUSH2 0x1000 MLOAD PUSH1 0 MSTORE PUSH1 32 PUSH1 0 RETURN
+    gas = 100000;
+    out = evmDispatchTest::exec("61100051600052" "60206000f3", gas);
+    BOOST_REQUIRE_EQUAL(out.size(), 32U);
+    BOOST_CHECK_EQUAL(dev::fromBigEndian<dev::u256>(out), 0);
+
+    // Empty output at any offset
+    gas = 100000;
+    BOOST_CHECK(evmDispatchTest::exec("6000610100f3", gas).empty());
+}
+
+BOOST_AUTO_TEST_CASE(evmdispatch_arena){
+    dev::eth::VMArena arena;
+    void* first = arena.allocate(100);
+    void* second = arena.allocate(1000);
+    BOOST_CHECK(static_cast<unsigned char*>(second) >= static_cast<unsigned char*>(first) + 100);
+
+    // Only the latest allocation is given back before a reset
+    arena.deallocate(first, 100);
+    arena.deallocate(second, 1000);
+    BOOST_CHECK(arena.allocate(10) == second);
+
+    // Larger than a chunk, then everything is reused from the largest chunk
+    void* large = arena.allocate(1 << 20);
+    arena.reset();
+    BOOST_CHECK(arena.allocate(1 << 20) == large);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
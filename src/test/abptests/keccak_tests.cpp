@@ -0,0 +1,122 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <random.h>
+#include <utilstrencodings.h>
+#include <libdevcore/SHA3.h>
+
+namespace keccakTest{
+
+/**
+ * The portable byte-wise libkeccak-tiny permutation and sponge that SHA3.cpp
+ * used before the optimized backend, kept here as the differential reference.
+ */
+static const uint8_t rho[24] = {1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44};
+static const uint8_t pi[24] = {10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1};
+static const uint64_t RC[24] = {
+    1ULL, 0x8082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x808bULL, 0x80000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x8aULL, 0x88ULL, 0x80008009ULL, 0x8000000aULL,
+    0x8000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x80000001ULL, 0x8000000080008008ULL};
+
+uint64_t rol(uint64_t x, int s) { return (x << s) | (x >> (64 - s)); }
+
+void keccakfReference(uint64_t* a)
+{
+    uint64_t b[5];
+    for (int i = 0; i < 24; i++) {
+        for (int x = 0; x < 5; x++) {
+            b[x] = 0;
+            for (int y = 0; y < 25; y += 5)
+                b[x] ^= a[x + y];
+        }
+        for (int x = 0; x < 5; x++)
+            for (int y = 0; y < 25; y += 5)
+                a[y + x] ^= b[(x + 4) % 5] ^ rol(b[(x + 1) % 5], 1);
+        uint64_t t = a[1];
+        for (int x = 0; x < 24; x++) {
+            b[0] = a[pi[x]];
+            a[pi[x]] = rol(t, rho[x]);
+            t = b[0];
+        }
+        for (int y = 0; y < 25; y += 5) {
+            for (int x = 0; x < 5; x++)
+                b[x] = a[y + x];
+            for (int x = 0; x < 5; x++)
+                a[y + x] = b[x] ^ ((~b[(x + 1) % 5]) & b[(x + 2) % 5]);
+        }
+        a[0] ^= RC[i];
+    }
+}
+
+dev::h256 sha3Reference(const std::vector<uint8_t>& in)
+{
+    const size_t rate = 136;
+    uint64_t lanes[25] = {0};
+    uint8_t* a = (uint8_t*)lanes;
+    const uint8_t* p = in.data();
+    size_t len = in.size();
+    while (len >= rate) {
+        for (size_t i = 0; i < rate; i++) a[i] ^= p[i];
+        keccakfReference(lanes);
+        p += rate;
+        len -= rate;
+    }
+    a[len] ^= 0x01;
+    a[rate - 1] ^= 0x80;
+    for (size_t i = 0; i < len; i++) a[i] ^= p[i];
+    keccakfReference(lanes);
+    dev::h256 ret;
+    memcpy(ret.data(), a, 32);
+    return ret;
+}
+
+std::vector<uint8_t> randomBytes(size_t len)
+{
+    std::vector<uint8_t> ret(len);
+    for (auto& b : ret) b = InsecureRandBits(8);
+    return ret;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(keccak_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(keccak_known_vectors){
+    BOOST_CHECK_EQUAL(dev::sha3(dev::bytesConstRef()).hex(), "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470");
+    BOOST_CHECK_EQUAL(dev::sha3(std::string("abc")).hex(), "4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45");
+    BOOST_CHECK(dev::EmptyListSHA3 == dev::h256("1dcc4de8dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d49347"));
+}
+
+BOOST_AUTO_TEST_CASE(keccak_matches_reference){
+    // Every length around the 136 byte rate boundaries, then random lengths.
+    for (size_t len = 0; len <= 3 * 136 + 1; ++len) {
+        std::vector<uint8_t> in = keccakTest::randomBytes(len);
+        BOOST_CHECK(dev::sha3(in) == keccakTest::sha3Reference(in));
+    }
+    for (int i = 0; i < 100; ++i) {
+        std::vector<uint8_t> in = keccakTest::randomBytes(InsecureRandRange(5000));
+        BOOST_CHECK(dev::sha3(in) == keccakTest::sha3Reference(in));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(keccak_batch){
+    // Mix single-block and multi-block inputs so the batch path has to gather
+    // short inputs around the long ones.
+    static const size_t lengths[] = {0, 32, 20, 135, 136, 32, 1, 300, 32, 64, 32, 20, 200, 134, 7, 32, 32};
+    std::vector<std::vector<uint8_t>> inputs;
+    for (size_t len : lengths)
+        inputs.push_back(keccakTest::randomBytes(len));
+    for (size_t count = 0; count <= inputs.size(); ++count) {
+        std::vector<dev::bytesConstRef> refs;
+        for (size_t i = 0; i < count; ++i)
+            refs.push_back(dev::bytesConstRef(&inputs[i]));
+        std::vector<dev::h256> hashes(count);
+        dev::sha3Batch(refs.data(), hashes.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            BOOST_CHECK(hashes[i] == keccakTest::sha3Reference(inputs[i]));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
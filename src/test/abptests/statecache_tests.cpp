@@ -0,0 +1,140 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <abptests/test_utils.h>
+#include <libdevcore/FlatHashMap.h>
+
+namespace stateCacheTest{
+
+dev::u256 GASLIMIT = dev::u256(500000);
+dev::h256 HASHTX = dev::h256(ParseHex("cccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc"));
+
+// Deploys PUSH1 0 SLOAD PUSH1 1 ADD PUSH1 0 SSTORE STOP, a counter in slot 0
+valtype COUNTER(ParseHex("600a600c600039600a6000f3" "60005460010160005500"));
+
+/*
+    contract sui {
+        address addr = 0x382f0a81f70a2c43e652c353caf15494d1b57fae;
+        function sui() payable {}
+        function kill() payable {
+            suicide(addr);
+        }
+        function () payable {}
+    }
+*/
+valtype SUICIDE(ParseHex("6060604052734de45add9f5f0b6887081cfcfe3aca6da9eb3365600060006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff1602179055505b5b5b60b68061006a6000396000f30060606040523615603d576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff16806341c0e1b5146045575b60435b5b565b005b604b604d565b005b600060009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16ff5b5600a165627a7a72305820e296f585c72ea3d4dce6880122cfe387d26c48b7960676a52e811b56ef8297a80029"));
+
+void executeReverted(std::vector<AbpTransaction> txs){
+    CBlock block(generateBlock());
+    ByteCodeExec exec(block, txs, uint64_t(GASLIMIT) * 10);
+    exec.performByteCode(dev::eth::Permanence::Reverted);
+}
+
+// Reset to the given roots with nothing cached, as a node fresh from a restart would be
+void resetState(dev::h256 const& stateRoot, dev::h256 const& utxoRoot){
+    globalState->setRoot(stateRoot);
+    globalState->setRootUTXO(utxoRoot);
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(statecache_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(statecache_flat_map){
+    dev::FlatHashMap<dev::u256, dev::u256> map;
+    BOOST_CHECK(map.find(1) == map.end());
+    for(unsigned i = 0; i < 1000; i++)
+        map[i] = i * 2;
+    BOOST_CHECK_EQUAL(map.size(), 1000U);
+    BOOST_CHECK(!map.emplace(5, 0).second);
+
+    // Erasing shifts the following entries back, all others stay reachable
+    for(unsigned i = 1; i < 1000; i += 2)
+        BOOST_CHECK_EQUAL(map.erase(i), 1U);
+    BOOST_CHECK_EQUAL(map.erase(1), 0U);
+    BOOST_CHECK_EQUAL(map.size(), 500U);
+    for(unsigned i = 0; i < 1000; i++){
+        auto it = map.find(i);
+        BOOST_CHECK_EQUAL(it != map.end(), i % 2 == 0);
+        if(it != map.end())
+            BOOST_CHECK(it->second == i * 2);
+    }
+
+    size_t n = 0;
+    for(auto const& i : map)
+        n += i.first % 2 == 0;
+    BOOST_CHECK_EQUAL(n, 500U);
+
+    map.clear();
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(statecache_across_transactions){
+    initState();
+    dev::h256 hash(stateCacheTest::HASHTX);
+    AbpTransaction create = createAbpTransaction(stateCacheTest::COUNTER, 0, stateCacheTest::GASLIMIT, dev::u256(1), hash, dev::Address(), 0);
+    dev::Address counter = createAbpAddress(create.getHashWith(), create.getNVout());
+    executeBC({create});
+    dev::h256 stateRoot = globalState->rootHash();
+    dev::h256 utxoRoot = globalState->rootHashUTXO();
+
+    std::vector<AbpTransaction> calls;
+    for(int i = 0; i < 3; i++)
+        calls.push_back(createAbpTransaction(valtype(), 0, stateCacheTest::GASLIMIT, dev::u256(1), ++hash, counter, 0));
+
+    // The counter stays cached from one transaction to the next
+    {
+        StateCacheScope scope(globalState);
+        executeBC(calls);
+        BOOST_CHECK(globalState->storage(counter, 0) == 3);
+    }
+    dev::h256 cachedRoot = globalState->rootHash();
+
+    // Reading everything from the trie for each transaction gives the same state
+    stateCacheTest::resetState(stateRoot, utxoRoot);
+    for(AbpTransaction const& call : calls){
+        executeBC({call});
+        stateCacheTest::resetState(globalState->rootHash(), globalState->rootHashUTXO());
+    }
+    BOOST_CHECK(globalState->rootHash() == cachedRoot);
+    BOOST_CHECK(globalState->storage(counter, 0) == 3);
+}
+
+BOOST_AUTO_TEST_CASE(statecache_revert){
+    initState();
+    dev::h256 hash(stateCacheTest::HASHTX);
+    AbpTransaction create = createAbpTransaction(stateCacheTest::COUNTER, 0, stateCacheTest::GASLIMIT, dev::u256(1), hash, dev::Address(), 0);
+    AbpTransaction createSuicide = createAbpTransaction(stateCacheTest::SUICIDE, 0, stateCacheTest::GASLIMIT, dev::u256(1), ++hash, dev::Address(), 0);
+    dev::Address counter = createAbpAddress(create.getHashWith(), create.getNVout());
+    dev::Address suicide = createAbpAddress(createSuicide.getHashWith(), createSuicide.getNVout());
+    AbpTransaction fund = createAbpTransaction(valtype(), 13, stateCacheTest::GASLIMIT, dev::u256(1), ++hash, suicide, 0);
+    AbpTransaction call = createAbpTransaction(valtype(), 0, stateCacheTest::GASLIMIT, dev::u256(1), ++hash, counter, 0);
+    executeBC({create, createSuicide, fund, call});
+    dev::h256 stateRoot = globalState->rootHash();
+    dev::h256 utxoRoot = globalState->rootHashUTXO();
+    BOOST_CHECK(globalState->storage(counter, 0) == 1);
+
+    // Reverted runs are undone through the changelog, with the accounts they
+    // changed and killed still cached
+    AbpTransaction kill = createAbpTransaction(ParseHex("41c0e1b5"), 0, stateCacheTest::GASLIMIT, dev::u256(1), ++hash, suicide, 0);
+    stateCacheTest::executeReverted({call, kill, call});
+    BOOST_CHECK(globalState->rootHash() == stateRoot);
+    BOOST_CHECK(globalState->rootHashUTXO() == utxoRoot);
+    BOOST_CHECK(globalState->storage(counter, 0) == 1);
+    BOOST_CHECK(globalState->addressInUse(suicide));
+    BOOST_CHECK(globalState->balance(suicide) == 13);
+
+    // Committing afterwards gives the same state as committing from the trie
+    executeBC({call, kill});
+    dev::h256 cachedRoot = globalState->rootHash();
+    dev::h256 cachedUTXORoot = globalState->rootHashUTXO();
+    BOOST_CHECK(globalState->storage(counter, 0) == 2);
+    BOOST_CHECK(!globalState->addressInUse(suicide));
+
+    stateCacheTest::resetState(stateRoot, utxoRoot);
+    executeBC({call, kill});
+    BOOST_CHECK(globalState->rootHash() == cachedRoot);
+    BOOST_CHECK(globalState->rootHashUTXO() == cachedUTXORoot);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
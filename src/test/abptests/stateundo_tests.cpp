@@ -0,0 +1,121 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <abptests/test_utils.h>
+#include <streams.h>
+#include <undo.h>
+
+namespace stateUndoTest{
+
+dev::u256 GASLIMIT = dev::u256(500000);
+dev::h256 HASHTX = dev::h256(ParseHex("bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"));
+
+/*
+    contract Factory {
+        bytes32[] Names;
+        address[] newContracts;
+
+        function createContract (bytes32 name) {
+            address newContract = new Contract(name);
+            newContracts.push(newContract);
+        }
+        ...
+    }
+*/
+valtype FACTORY(ParseHex("606060405234610000575b61034a806100196000396000f30060606040526000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff1680633f811b80146100495780636b8ff5741461006a575b610000565b3461000057610068600480803560001916906020019091905050610087565b005b3461000057610085600480803590602001909190505061015b565b005b60008160405160e18061023e833901808260001916600019168152602001915050604051809103906000f08015610000579050600180548060010182818154818355818115116101035781836000526020600020918201910161010291905b808211156100fe5760008160009055506001016100e6565b5090565b5b505050916000526020600020900160005b83909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550505b5050565b6000600182815481101561000057906000526020600020900160005b9054906101000a900473ffffffffffffffffffffffffffffffffffffffff1690508073ffffffffffffffffffffffffffffffffffffffff16638052474d6000604051602001526040518163ffffffff167c0100000000000000000000000000000000000000000000000000000000028152600401809050602060405180830381600087803b156100005760325a03f1156100005750505060405180519050600083815481101561000057906000526020600020900160005b5081600019169055505b50505600606060405234610000576040516020806100e1833981016040528080519060200190919050505b80600081600019169055505b505b609f806100426000396000f30060606040523615603d576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff1680638052474d146045575b60435b5b565b005b34600057604f606d565b60405180826000191660001916815260200191505060405180910390f35b600054815600a165627a7a72305820fe28ec2b77f3b306095bda73561b85d147a1026db2e5714aeeb2f29246cffcbb0029a165627a7a7230582086cf938db13cf2aa8bca8ad6e720861683ef2cc971ad66dad68708438a5e4a9b0029"));
+
+/*
+    contract sui {
+        address addr = 0x382f0a81f70a2c43e652c353caf15494d1b57fae;
+        function sui() payable {}
+        function kill() payable {
+            suicide(addr);
+        }
+        function () payable {}
+    }
+*/
+valtype SUICIDE(ParseHex("6060604052734de45add9f5f0b6887081cfcfe3aca6da9eb3365600060006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff1602179055505b5b5b60b68061006a6000396000f30060606040523615603d576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff16806341c0e1b5146045575b60435b5b565b005b604b604d565b005b600060009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16ff5b5600a165627a7a72305820e296f585c72ea3d4dce6880122cfe387d26c48b7960676a52e811b56ef8297a80029"));
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(stateundo_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(stateundo_apply){
+    initState();
+    dev::h256 hash(stateUndoTest::HASHTX);
+    AbpTransaction createFactory = createAbpTransaction(stateUndoTest::FACTORY, 0, stateUndoTest::GASLIMIT, dev::u256(1), hash, dev::Address(), 0);
+    AbpTransaction createSuicide = createAbpTransaction(stateUndoTest::SUICIDE, 0, stateUndoTest::GASLIMIT, dev::u256(1), ++hash, dev::Address(), 0);
+    dev::Address factory = createAbpAddress(createFactory.getHashWith(), createFactory.getNVout());
+    dev::Address suicide = createAbpAddress(createSuicide.getHashWith(), createSuicide.getNVout());
+    AbpTransaction fund = createAbpTransaction(valtype(), 13, stateUndoTest::GASLIMIT, dev::u256(1), ++hash, suicide, 0);
+    executeBC({createFactory, createSuicide, fund});
+
+    dev::h256 stateRoot = globalState->rootHash();
+    dev::h256 utxoRoot = globalState->rootHashUTXO();
+    BOOST_CHECK(globalState->balance(suicide) == 13);
+
+    // Storage writes, new contracts, a suicide and a spent contract UTXO
+    CContractUndo undo;
+    {
+        StateUndoRecorder recorder(globalState, &undo);
+        std::vector<AbpTransaction> txs;
+        for (int i = 0; i < 3; i++)
+            txs.push_back(createAbpTransaction(ParseHex("3f811b80"), 0, stateUndoTest::GASLIMIT, dev::u256(1), ++hash, factory, 0));
+        txs.push_back(createAbpTransaction(ParseHex("41c0e1b5"), 0, stateUndoTest::GASLIMIT, dev::u256(1), ++hash, suicide, 0));
+        executeBC(txs);
+    }
+    BOOST_CHECK(globalState->rootHash() != stateRoot);
+    BOOST_CHECK(globalState->rootHashUTXO() != utxoRoot);
+    BOOST_CHECK(!globalState->addressInUse(suicide));
+    BOOST_CHECK(!undo.IsNull());
+    BOOST_CHECK(!undo.vUTXOs.empty());
+
+    // Applying the undo on top of the state it was recorded against leads back to the prior roots
+    globalState->applyUndo(undo);
+    BOOST_CHECK(globalState->rootHash() == stateRoot);
+    BOOST_CHECK(globalState->rootHashUTXO() == utxoRoot);
+    BOOST_CHECK(globalState->balance(suicide) == 13);
+
+    // Changes outside the recorder's scope are not recorded
+    size_t nAccounts = undo.vAccounts.size();
+    executeBC({createAbpTransaction(ParseHex("3f811b80"), 0, stateUndoTest::GASLIMIT, dev::u256(1), ++hash, factory, 0)});
+    BOOST_CHECK_EQUAL(undo.vAccounts.size(), nAccounts);
+}
+
+BOOST_AUTO_TEST_CASE(stateundo_serialization){
+    CBlockUndo blockundo;
+    blockundo.vtxundo.resize(2);
+
+    // Blocks without contract state changes keep the old record layout
+    CDataStream ssPlain(SER_DISK, CLIENT_VERSION);
+    ssPlain << blockundo;
+    CDataStream ssVtxOnly(SER_DISK, CLIENT_VERSION);
+    ssVtxOnly << blockundo.vtxundo;
+    BOOST_CHECK(ssPlain.str() == ssVtxOnly.str());
+
+    CAccountUndo account;
+    account.address = uint160(ParseHex("0101010101010101010101010101010101010101"));
+    account.vchPrior = ParseHex("c3010203");
+    account.vStorage.push_back(std::make_pair(InsecureRand256(), ParseHex("05")));
+    account.vStorage.push_back(std::make_pair(InsecureRand256(), valtype()));
+    blockundo.contractundo.vAccounts.push_back(account);
+    blockundo.contractundo.vUTXOs.push_back(std::make_pair(uint160(), valtype()));
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << blockundo;
+    CBlockUndo read;
+    ss >> read;
+    BOOST_CHECK(ss.empty());
+    BOOST_CHECK_EQUAL(read.vtxundo.size(), 2U);
+    BOOST_REQUIRE_EQUAL(read.contractundo.vAccounts.size(), 1U);
+    BOOST_CHECK(read.contractundo.vAccounts[0].address == account.address);
+    BOOST_CHECK(read.contractundo.vAccounts[0].vchPrior == account.vchPrior);
+    BOOST_CHECK(read.contractundo.vAccounts[0].vStorage == account.vStorage);
+    BOOST_CHECK_EQUAL(read.contractundo.vUTXOs.size(), 1U);
+
+    CBlockUndo readPlain;
+    ssPlain >> readPlain;
+    BOOST_CHECK_EQUAL(readPlain.vtxundo.size(), 2U);
+    BOOST_CHECK(readPlain.contractundo.IsNull());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
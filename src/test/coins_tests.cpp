@@ -656,6 +656,41 @@ BOOST_AUTO_TEST_CASE(ccoins_access)
     CheckAccessCoin(VALUE1, VALUE2, VALUE2, DIRTY|FRESH, DIRTY|FRESH);
 }
 
+void CheckCacheFetchedCoin(CAmount base_value, CAmount cache_value, CAmount expected_value, char cache_flags, char expected_flags)
+{
+    SingleEntryCacheTest test(base_value, cache_value, cache_flags);
+    Coin coin;
+    if (test.base.GetCoin(OUTPOINT, coin))
+        test.cache.CacheFetchedCoin(OUTPOINT, std::move(coin));
+    test.cache.SelfTest();
+
+    CAmount result_value;
+    char result_flags;
+    GetCoinsMapEntry(test.cache.map(), result_value, result_flags);
+    BOOST_CHECK_EQUAL(result_value, expected_value);
+    BOOST_CHECK_EQUAL(result_flags, expected_flags);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_cache_fetched)
+{
+    /* Check that a coin read from the base view by a prefetch ends up in the
+     * cache like AccessCoin would have put it there, and never replaces an
+     * entry the cache already has.
+     *
+     *                     Base    Cache   Result  Cache        Result
+     *                     Value   Value   Value   Flags        Flags
+     */
+    CheckCacheFetchedCoin(ABSENT, ABSENT, ABSENT, NO_ENTRY   , NO_ENTRY   );
+    CheckCacheFetchedCoin(PRUNED, ABSENT, ABSENT, NO_ENTRY   , NO_ENTRY   );
+    CheckCacheFetchedCoin(VALUE1, ABSENT, VALUE1, NO_ENTRY   , 0          );
+    CheckCacheFetchedCoin(VALUE1, PRUNED, PRUNED, 0          , 0          );
+    CheckCacheFetchedCoin(VALUE1, PRUNED, PRUNED, DIRTY      , DIRTY      );
+    CheckCacheFetchedCoin(VALUE1, PRUNED, PRUNED, DIRTY|FRESH, DIRTY|FRESH);
+    CheckCacheFetchedCoin(VALUE1, VALUE2, VALUE2, 0          , 0          );
+    CheckCacheFetchedCoin(VALUE1, VALUE2, VALUE2, FRESH      , FRESH      );
+    CheckCacheFetchedCoin(VALUE1, VALUE2, VALUE2, DIRTY      , DIRTY      );
+}
+
 void CheckSpendCoins(CAmount base_value, CAmount cache_value, CAmount expected_value, char cache_flags, char expected_flags)
 {
     SingleEntryCacheTest test(base_value, cache_value, cache_flags);
@@ -0,0 +1,118 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <coins.h>
+#include <coinstats.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <undo.h>
+#include <test/test_bitcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(coinstats_tests, BasicTestingSetup)
+
+static CTransactionRef MakeTx(const COutPoint& prevout, const std::vector<CAmount>& values, bool fUnspendable = false)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = prevout;
+    for (CAmount nValue : values) {
+        tx.vout.push_back(CTxOut(nValue, CScript() << OP_TRUE));
+    }
+    if (fUnspendable) {
+        tx.vout.push_back(CTxOut(0, CScript() << OP_RETURN));
+    }
+    return MakeTransactionRef(tx);
+}
+
+static uint256 MuHashOf(const std::vector<std::pair<COutPoint, Coin>>& coins)
+{
+    MuHash3072 muhash;
+    for (const auto& coin : coins) {
+        MuHashInsertCoin(muhash, coin.first, coin.second);
+    }
+    uint256 out;
+    muhash.Finalize(out.begin());
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(coinstats_index)
+{
+    CCoinStatsIndex index(1 << 20, true, true);
+
+    uint256 hashes[3] = {InsecureRand256(), InsecureRand256(), InsecureRand256()};
+    CBlockIndex blockIndexes[3];
+    for (int i = 0; i < 3; ++i) {
+        blockIndexes[i].phashBlock = &hashes[i];
+        blockIndexes[i].nHeight = i;
+        blockIndexes[i].pprev = i ? &blockIndexes[i - 1] : nullptr;
+    }
+    BOOST_CHECK(index.Reset(hashes[0]));
+    CCoinStatsEntry stats;
+    BOOST_CHECK(index.LookupStats(hashes[0], stats));
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, 0U);
+    BOOST_CHECK(stats.hashMuHash == MuHashOf({}));
+
+    // Block 1 only has a coinbase, whose OP_RETURN output is left out
+    CBlock block1;
+    block1.vtx.push_back(MakeTx(COutPoint(), {50 * COIN}, true));
+    CBlockUndo undo1;
+    BOOST_CHECK(index.ConnectBlock(block1, &blockIndexes[1], undo1));
+    BOOST_CHECK(index.GetBestBlock() == hashes[1]);
+
+    COutPoint coinbase1(block1.vtx[0]->GetHash(), 0);
+    Coin coin1(block1.vtx[0]->vout[0], 1, true, false);
+    BOOST_CHECK(index.LookupStats(hashes[1], stats));
+    BOOST_CHECK_EQUAL(stats.nHeight, 1);
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, 1U);
+    BOOST_CHECK_EQUAL(stats.nTotalAmount, 50 * COIN);
+    BOOST_CHECK_EQUAL(stats.nBogoSize, GetBogoSize(coin1));
+    BOOST_CHECK(stats.hashMuHash == MuHashOf({{coinbase1, coin1}}));
+
+    // Block 2 spends it into two outputs, one of which is spent again in the block
+    CBlock block2;
+    block2.vtx.push_back(MakeTx(COutPoint(), {10 * COIN}));
+    block2.vtx.push_back(MakeTx(coinbase1, {20 * COIN, 30 * COIN}));
+    COutPoint spent(block2.vtx[1]->GetHash(), 1);
+    block2.vtx.push_back(MakeTx(spent, {29 * COIN}));
+    CBlockUndo undo2;
+    undo2.vtxundo.resize(2);
+    undo2.vtxundo[0].vprevout.push_back(coin1);
+    undo2.vtxundo[1].vprevout.push_back(Coin(block2.vtx[1]->vout[1], 2, false, false));
+    BOOST_CHECK(index.ConnectBlock(block2, &blockIndexes[2], undo2));
+
+    std::vector<std::pair<COutPoint, Coin>> coins2 = {
+        {COutPoint(block2.vtx[0]->GetHash(), 0), Coin(block2.vtx[0]->vout[0], 2, true, false)},
+        {COutPoint(block2.vtx[1]->GetHash(), 0), Coin(block2.vtx[1]->vout[0], 2, false, false)},
+        {COutPoint(block2.vtx[2]->GetHash(), 0), Coin(block2.vtx[2]->vout[0], 2, false, false)},
+    };
+    BOOST_CHECK(index.LookupStats(hashes[2], stats));
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, 3U);
+    BOOST_CHECK_EQUAL(stats.nTotalAmount, 59 * COIN);
+    BOOST_CHECK(stats.hashMuHash == MuHashOf(coins2));
+    CCoinStatsEntry stats2 = stats;
+
+    // Blocks not on top of the index are left alone
+    BOOST_CHECK(index.ConnectBlock(block2, &blockIndexes[2], undo2));
+    BOOST_CHECK(index.DisconnectBlock(block1, &blockIndexes[1], undo1));
+    BOOST_CHECK(index.GetBestBlock() == hashes[2]);
+
+    // Disconnecting goes back to the statistics of block 1, and connecting
+    // again gives those of block 2
+    BOOST_CHECK(index.DisconnectBlock(block2, &blockIndexes[2], undo2));
+    BOOST_CHECK(index.GetBestBlock() == hashes[1]);
+    BOOST_CHECK(index.ConnectBlock(block2, &blockIndexes[2], undo2));
+    BOOST_CHECK(index.LookupStats(hashes[2], stats));
+    BOOST_CHECK(stats.hashMuHash == stats2.hashMuHash);
+    BOOST_CHECK_EQUAL(stats.nBogoSize, stats2.nBogoSize);
+
+    // Undo data missing a spent coin is refused
+    undo2.vtxundo[1].vprevout.clear();
+    BOOST_CHECK(index.DisconnectBlock(block2, &blockIndexes[2], undo2) == false);
+    BOOST_CHECK(index.GetBestBlock() == hashes[2]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
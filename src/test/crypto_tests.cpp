@@ -10,6 +10,8 @@
 #include <crypto/sha512.h>
 #include <crypto/hmac_sha256.h>
 #include <crypto/hmac_sha512.h>
+#include <crypto/muhash.h>
+#include <hash.h>
 #include <random.h>
 #include <utilstrencodings.h>
 #include <test/test_bitcoin.h>
@@ -268,6 +270,36 @@ BOOST_AUTO_TEST_CASE(sha256_testvectors) {
     TestSHA256(test1, "a316d55510b49662420f49d145d42fb83f31ef8dc016aa4e32df049991a91e26");
 }
 
+BOOST_AUTO_TEST_CASE(sha256d64)
+{
+    static const sha256_implementation::UseImplementation impls[] = {
+        sha256_implementation::STANDARD,
+        sha256_implementation::USE_SSE4,
+        sha256_implementation::USE_SSE4_AND_AVX2,
+        sha256_implementation::USE_SSE4_AND_SHANI,
+        sha256_implementation::USE_ALL,
+    };
+    for (sha256_implementation::UseImplementation impl : impls) {
+        SHA256AutoDetect(impl);
+        for (int i = 0; i <= 32; ++i) {
+            unsigned char in[64 * 32];
+            unsigned char out1[32 * 32], out2[32 * 32];
+            for (int j = 0; j < 64 * i; ++j) {
+                in[j] = InsecureRandBits(8);
+            }
+            for (int j = 0; j < i; ++j) {
+                CHash256().Write(in + 64 * j, 64).Finalize(out1 + 32 * j);
+            }
+            SHA256D64(out2, in, i);
+            BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+            // In place, as used by ComputeMerkleRoot.
+            SHA256D64(in, in, i);
+            BOOST_CHECK(memcmp(out1, in, 32 * i) == 0);
+        }
+    }
+    SHA256AutoDetect();
+}
+
 BOOST_AUTO_TEST_CASE(sha512_testvectors) {
     TestSHA512("",
                "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
@@ -546,4 +578,87 @@ BOOST_AUTO_TEST_CASE(countbits_tests)
     }
 }
 
+static uint256 MuHashFinal(MuHash3072 muhash)
+{
+    uint256 out;
+    muhash.Finalize(out.begin());
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(muhash_tests)
+{
+    const unsigned char x[] = {1, 2, 3};
+    const unsigned char y[] = {4, 5};
+    const unsigned char z[] = {6};
+
+    // The hash of the empty set is that of the number 1
+    unsigned char one[Num3072::BYTE_SIZE] = {1};
+    uint256 hashOne;
+    CSHA256().Write(one, sizeof(one)).Finalize(hashOne.begin());
+    BOOST_CHECK(MuHashFinal(MuHash3072()) == hashOne);
+
+    // Order does not matter, and removing takes back inserting
+    MuHash3072 xy, yx, xyz;
+    xy.Insert(x, sizeof(x)).Insert(y, sizeof(y));
+    yx.Insert(y, sizeof(y)).Insert(x, sizeof(x));
+    xyz.Insert(z, sizeof(z)).Insert(x, sizeof(x)).Insert(y, sizeof(y));
+    BOOST_CHECK(MuHashFinal(xy) == MuHashFinal(yx));
+    BOOST_CHECK(MuHashFinal(xy) != MuHashFinal(xyz));
+    BOOST_CHECK(MuHashFinal(xy) != MuHashFinal(MuHash3072(x, sizeof(x))));
+    MuHash3072 removed = xyz;
+    removed.Remove(z, sizeof(z));
+    BOOST_CHECK(MuHashFinal(removed) == MuHashFinal(xy));
+    MuHash3072 early;
+    early.Remove(x, sizeof(x)).Insert(y, sizeof(y)).Insert(x, sizeof(x));
+    BOOST_CHECK(MuHashFinal(early) == MuHashFinal(MuHash3072(y, sizeof(y))));
+
+    // Sets combine by multiplication
+    MuHash3072 combined(z, sizeof(z));
+    combined *= xy;
+    BOOST_CHECK(MuHashFinal(combined) == MuHashFinal(xyz));
+    combined /= MuHash3072(z, sizeof(z));
+    BOOST_CHECK(MuHashFinal(combined) == MuHashFinal(xy));
+
+    // The state survives serialization with a pending denominator
+    CDataStream ss(SER_DISK, 0);
+    ss << removed;
+    MuHash3072 read;
+    ss >> read;
+    BOOST_CHECK(MuHashFinal(read) == MuHashFinal(xy));
+}
+
+BOOST_AUTO_TEST_CASE(num3072_reduction)
+{
+    // p - 1 = 2^3072 - 1103718 squares to 1
+    unsigned char data[Num3072::BYTE_SIZE];
+    memset(data, 0xff, sizeof(data));
+    WriteLE64(data, ~(uint64_t)1103717);
+    Num3072 minusOne(data);
+    Num3072 square = minusOne;
+    square.Multiply(minusOne);
+    unsigned char out[Num3072::BYTE_SIZE];
+    square.ToBytes(out);
+    unsigned char one[Num3072::BYTE_SIZE] = {1};
+    BOOST_CHECK(memcmp(out, one, sizeof(out)) == 0);
+
+    // 2^3072 - 1 is above p and reduces to 1103716
+    memset(data, 0xff, sizeof(data));
+    Num3072 above(data);
+    above.Multiply(Num3072());
+    above.ToBytes(out);
+    unsigned char expected[Num3072::BYTE_SIZE] = {};
+    WriteLE64(expected, 1103716);
+    BOOST_CHECK(memcmp(out, expected, sizeof(out)) == 0);
+
+    // Dividing a number by itself gives 1
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = InsecureRandBits(8);
+    }
+    Num3072 a(data);
+    Num3072 quotient = a;
+    quotient.Divide(a);
+    quotient.ToBytes(out);
+    BOOST_CHECK(memcmp(out, one, sizeof(out)) == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()